@@ -13,4 +13,8 @@ endif()
 
 if(NOT TARGET ez::meta)
 	find_dependency(ez-meta CONFIG)
+endif()
+
+if(NOT TARGET Threads::Threads)
+	find_dependency(Threads)
 endif()
\ No newline at end of file
@@ -7,19 +7,25 @@
 #include <vector>
 #include <array>
 #include <limits>
+#include <memory>
+#include <memory_resource>
 #include <glm/vec2.hpp>
 
 #include <ez/bezier/intern/BezierInterpolation.hpp>
 #include <ez/bezier/intern/BezierLength.hpp>
+#include <ez/bezier/intern/BPathSegments.hpp>
 
 namespace ez {
-	template<typename vec_t>
+	// The allocator parameter allows the points to be placed in an arena or pool, see ez::pmr::BPath
+	template<typename vec_t, typename Alloc = std::allocator<vec_t>>
 	class BPath {
 	public:
 		using value_type = vec_t;
 		using real_t = ez::vec_value_t<vec_t>;
+		using allocator_type = Alloc;
 
 		static_assert(std::is_floating_point_v<real_t>, "ez::BPath requires floating point type!");
+		static_assert(std::is_same_v<typename std::allocator_traits<Alloc>::value_type, vec_t>, "ez::BPath requires an allocator for the vector type!");
 
 		using Point = value_type;
 
@@ -31,7 +37,7 @@ namespace ez {
 		using const_reference = const value_type&;
 		using const_pointer = const value_type*;
 
-		using Container = std::vector<Point>;
+		using Container = std::vector<Point, Alloc>;
 
 		using iterator = typename Container::iterator;
 		using const_iterator = typename Container::const_iterator;
@@ -48,15 +54,20 @@ namespace ez {
 			: open(true)
 		{}
 
-		BPath(size_type n, const_reference point, bool _open = true)
+		explicit BPath(const allocator_type& alloc)
+			: open(true)
+			, points(alloc)
+		{}
+
+		BPath(size_type n, const_reference point, bool _open = true, const allocator_type& alloc = allocator_type{})
 			: open(_open)
-			, points(n, point)
+			, points(n, point, alloc)
 		{}
 
 		template<typename Iter>
-		BPath(Iter first, Iter last, bool _open = true)
+		BPath(Iter first, Iter last, bool _open = true, const allocator_type& alloc = allocator_type{})
 			: open(_open)
-			, points(first, last)
+			, points(first, last, alloc)
 		{
 			static_assert(ez::is_input_iterator_v<Iter>, "ez::BPath::BPath requires an input iterator!");
 		}
@@ -66,11 +77,22 @@ namespace ez {
 			, points(other.points)
 		{}
 
+		BPath(const BPath& other, const allocator_type& alloc)
+			: open(other.open)
+			, points(other.points, alloc)
+		{}
+
 		BPath(BPath&& other) noexcept
 			: open(other.open)
 			, points(std::move(other.points))
 		{}
 
+		// If the allocators differ, the points are copied into the new allocator
+		BPath(BPath&& other, const allocator_type& alloc)
+			: open(other.open)
+			, points(std::move(other.points), alloc)
+		{}
+
 		BPath& operator=(const BPath& other) {
 			points = other.points;
 			open = other.open;
@@ -78,7 +100,7 @@ namespace ez {
 			return *this;
 		}
 
-		BPath& operator=(BPath&& other) noexcept {
+		BPath& operator=(BPath&& other) noexcept(std::is_nothrow_move_assignable_v<Container>) {
 			points = std::move(other.points);
 			open = other.open;
 
@@ -87,101 +109,61 @@ namespace ez {
 		
 		// Converts a real value between 0 and 1, into a segment index and an interpolation value for that segment
 		Index indexAt(real_t t) const {
-			t = std::max(real_t(0), std::max(t, real_t(0.999999)));
-
-			real_t delta, index;
-			delta = modf(t * static_cast<real_t>(numSegments()), &index);
-
-			return Index{ static_cast<size_type>(index), delta };
+			Index result;
+			result.index = intern::bpathIndexAt(t, numSegments(), result.delta);
+			return result;
 		}
 
 		// The real meat of this class, what makes it useful.
 		Segment segmentAt(size_type i) const {
-			static constexpr real_t lower(8 / 12.0);
-			static constexpr real_t upper = real_t(1) - lower;
-
-			static constexpr real_t b = real_t{ 9 } / real_t{ 12 };
-			static constexpr real_t a = (1.0 - b) / 2.0;
-
 			assert(i < numSegments());
-			Segment seg;
-
-			vec_t p0, p1, p2;
-
-			if (isClosed()) {
-				size_type
-					i1 = wrapIndex(i + 1),
-					i2 = wrapIndex(i + 2),
-					i3 = wrapIndex(i + 3),
-					i4 = wrapIndex(i + 4);
-
-				p0 = points[i ] * a + points[i1] * b + points[i2] * a;
-				p1 = points[i1] * a + points[i2] * b + points[i3] * a;
-				p2 = points[i2] * a + points[i3] * b + points[i4] * a;
-			}
-			else {
-				if (i == 0) {
-					// first segment
-					p0 = points[0];
-					p1 = points[0]*a + points[1]*b + points[2]*a;
-					p2 = points[1]*a + points[2]*b + points[3]*a;
-				}
-				else if (i == (numPoints() - 3)) {
-					// last segment
-					p0 = points[points.size() - 4]*a + points[points.size() - 3]*b + points[points.size() - 2]*a;
-					p1 = points[points.size() - 3]*a + points[points.size() - 2]*b + points[points.size() - 1]*a;
-					p2 = points[points.size() - 1];
-				}
-				else {
-					// middle segment
-					i -= 1;
-					size_type
-						i1 = (i + 1),
-						i2 = (i + 2),
-						i3 = (i + 3),
-						i4 = (i + 4);
-
-					p0 = points[i ] * a + points[i1] * b + points[i2] * a;
-					p1 = points[i1] * a + points[i2] * b + points[i3] * a;
-					p2 = points[i2] * a + points[i3] * b + points[i4] * a;
-				}
-			}
-
-			seg[0] = ez::bezier::interpolate(p0, p1, real_t{ 0.5 });
-			seg[3] = ez::bezier::interpolate(p1, p2, real_t{ 0.5 });
-
-			seg[1] = ez::bezier::interpolate(seg[0], p1, lower);
-			seg[2] = ez::bezier::interpolate(p1, seg[3], upper);
-
-			return seg;
+			return intern::bpathSegment(points.data(), points.size(), isOpen(), i);
 		}
 
 		size_type numSegments() const {
-			if (points.size() > 3) {
-				if (isOpen()) {
-					return points.size() - size_type(2);
-				}
-				else {
-					return points.size();
-				}
-			}
-			else {
-				return 0;
-			}
+			return intern::bpathNumSegments(points.size(), isOpen());
 		}
 
 		real_t length() const {
 			real_t total = real_t(0);
 
-			size_type count = numSegments();
-			for (size_type i = 0; i < count; ++i) {
-				Segment seg = segmentAt(i);
-				total += ez::bezier::length(seg[0], seg[1], seg[2], seg[3]);
-			}
+			intern::bpathForEachSegment(points.data(), points.size(), isOpen(), [&total](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				total += ez::bezier::length(p0, p1, p2, p3);
+			});
 
 			return total;
 		}
 
+		// Write all the segments of the path into the output iterator, returns the number of segments written.
+		// Faster than calling segmentAt for each index, since neighbouring segments share their blended points.
+		template<typename output_iter>
+		size_type toSegments(output_iter output) const {
+			static_assert(ez::is_output_iterator_v<output_iter>, "ez::BPath::toSegments requires an output iterator!");
+			static_assert(ez::is_iterator_writable_v<output_iter, Segment>, "ez::BPath::toSegments requires the output iterator to accept Segment values!");
+
+			intern::bpathForEachSegment(points.data(), points.size(), isOpen(), [&output](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				*output++ = Segment{ { p0, p1, p2, p3 } };
+			});
+
+			return numSegments();
+		}
+
+		// Same as toSegments, but writes each control of the segments into a separate output.
+		template<typename output_iter>
+		size_type toSegmentsSoA(output_iter out0, output_iter out1, output_iter out2, output_iter out3) const {
+			static_assert(ez::is_output_iterator_v<output_iter>, "ez::BPath::toSegmentsSoA requires output iterators!");
+			static_assert(ez::is_iterator_writable_v<output_iter, Point>, "ez::BPath::toSegmentsSoA requires the output iterators to accept Point values!");
+
+			intern::bpathForEachSegment(points.data(), points.size(), isOpen(), [&](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				*out0++ = p0;
+				*out1++ = p1;
+				*out2++ = p2;
+				*out3++ = p3;
+			});
+
+			return numSegments();
+		}
+
 		Point evalAt(Index index) const {
 			Segment seg = segmentAt(index.index);
 			return ez::bezier::interpolate(seg[0], seg[1], seg[2], seg[3], index.delta);
@@ -221,7 +203,7 @@ namespace ez {
 		void assign(Iter first, Iter last) {
 			static_assert(ez::is_input_iterator_v<Iter>, "ez::BPath::assign requires an input iterator!");
 
-			points.assign<Iter>(first, last);
+			points.assign(first, last);
 		}
 
 		void assign(size_type n, const_reference point) {
@@ -242,7 +224,7 @@ namespace ez {
 		void insert(const_iterator it, Iter first, Iter last) {
 			static_assert(ez::is_input_iterator_v<Iter>, "ez::BPath::insert requires an input iterator!");
 
-			points.insert<Iter>(it, first, last);
+			points.insert(it, first, last);
 		}
 		void insert(const_iterator it, std::initializer_list<Point> il) {
 			points.insert(it, il);
@@ -321,7 +303,9 @@ namespace ez {
 			return points.crend();
 		}
 
+		// Both paths must use equal allocators, like the standard containers swapping with a non propagating allocator.
 		void swap(BPath& other) noexcept {
+			assert(get_allocator() == other.get_allocator());
 			points.swap(other.points);
 			std::swap(open, other.open);
 		}
@@ -357,15 +341,19 @@ namespace ez {
 		BPath clone() const {
 			return BPath{ *this };
 		}
+
+		allocator_type get_allocator() const {
+			return points.get_allocator();
+		}
 	private:
 		bool open;
 		Container points;
-		
-		size_type wrapIndex(size_type i) const noexcept {
-			if (i >= numPoints()) {
-				i -= numPoints();
-			}
-			return i;
-		}
+	};
+
+	namespace pmr {
+		// BPath using a polymorphic allocator, so that many paths can share a single memory resource.
+		// For example, a std::pmr::monotonic_buffer_resource that is released once per frame.
+		template<typename vec_t>
+		using BPath = ez::BPath<vec_t, std::pmr::polymorphic_allocator<vec_t>>;
 	};
 };
\ No newline at end of file
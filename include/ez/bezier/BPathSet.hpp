@@ -0,0 +1,249 @@
+#pragma once
+#include <ez/meta.hpp>
+#include <cinttypes>
+#include <cassert>
+#include <vector>
+#include <array>
+#include <utility>
+
+#include <ez/bezier/BPath.hpp>
+#include <ez/bezier/intern/BezierInterpolation.hpp>
+#include <ez/bezier/intern/BezierLength.hpp>
+#include <ez/bezier/intern/BPathSegments.hpp>
+
+namespace ez {
+	/*
+	Many BPaths stored in a single contiguous buffer.
+	The points of path 'i' are in the range [offsets[i], offsets[i+1]) of the point buffer.
+	Use this instead of a container of BPath when there are a large number of paths, it avoids an allocation per path.
+	*/
+	template<typename vec_t>
+	class BPathSet {
+	public:
+		using value_type = vec_t;
+		using real_t = ez::vec_value_t<vec_t>;
+
+		static_assert(std::is_floating_point_v<real_t>, "ez::BPathSet requires floating point type!");
+
+		using Point = value_type;
+
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		using reference = value_type&;
+		using pointer = value_type*;
+		using const_reference = const value_type&;
+		using const_pointer = const value_type*;
+
+		using Segment = std::array<Point, 4>;
+		using Index = typename BPath<vec_t>::Index;
+
+		~BPathSet() = default;
+		BPathSet(const BPathSet&) = default;
+		BPathSet& operator=(const BPathSet&) = default;
+
+		// The moved from set is left empty, and can be reused.
+		// Restoring its leading zero offset may allocate, so these are not noexcept.
+		BPathSet(BPathSet&& other)
+			: points(std::move(other.points))
+			, offsets(std::move(other.offsets))
+			, flags(std::move(other.flags))
+		{
+			other.clear();
+		}
+		BPathSet& operator=(BPathSet&& other) {
+			if (this != &other) {
+				points = std::move(other.points);
+				offsets = std::move(other.offsets);
+				flags = std::move(other.flags);
+				other.clear();
+			}
+			return *this;
+		}
+
+		BPathSet()
+			: offsets{ size_type(0) }
+		{}
+
+		void reserve(size_type pathCount, size_type pointCount) {
+			offsets.reserve(pathCount + 1);
+			flags.reserve(pathCount);
+			points.reserve(pointCount);
+		}
+
+		// Add a new path to the end of the set, returns the index of the new path.
+		template<typename Iter>
+		size_type addPath(Iter first, Iter last, bool open = true) {
+			static_assert(ez::is_input_iterator_v<Iter>, "ez::BPathSet::addPath requires an input iterator!");
+
+			points.insert(points.end(), first, last);
+			offsets.push_back(points.size());
+			flags.push_back(open ? 1 : 0);
+
+			return numPaths() - 1;
+		}
+
+		template<typename Alloc>
+		size_type addPath(const BPath<vec_t, Alloc>& path) {
+			return addPath(path.begin(), path.end(), path.isOpen());
+		}
+
+		void pop_back() {
+			assert(numPaths() != 0);
+			offsets.pop_back();
+			flags.pop_back();
+			points.resize(offsets.back());
+		}
+
+		void clear() {
+			points.clear();
+			flags.clear();
+			offsets.clear();
+			offsets.push_back(0);
+		}
+
+		bool empty() const {
+			return flags.empty();
+		}
+		size_type size() const {
+			return flags.size();
+		}
+		size_type numPaths() const {
+			return flags.size();
+		}
+
+		// Total number of points in all the paths
+		size_type totalPoints() const {
+			return points.size();
+		}
+
+		size_type numPoints(size_type path) const {
+			assert(path < numPaths());
+			return offsets[path + 1] - offsets[path];
+		}
+
+		pointer pathData(size_type path) {
+			assert(path < numPaths());
+			return points.data() + offsets[path];
+		}
+		const_pointer pathData(size_type path) const {
+			assert(path < numPaths());
+			return points.data() + offsets[path];
+		}
+
+		reference pointAt(size_type path, size_type i) {
+			assert(i < numPoints(path));
+			return pathData(path)[i];
+		}
+		const_reference pointAt(size_type path, size_type i) const {
+			assert(i < numPoints(path));
+			return pathData(path)[i];
+		}
+
+		bool isOpen(size_type path) const {
+			assert(path < numPaths());
+			return flags[path] != 0;
+		}
+		bool isClosed(size_type path) const {
+			return !isOpen(path);
+		}
+		void setOpen(size_type path, bool value) {
+			assert(path < numPaths());
+			flags[path] = value ? 1 : 0;
+		}
+		void setClosed(size_type path, bool value) {
+			setOpen(path, !value);
+		}
+
+		size_type numSegments(size_type path) const {
+			return intern::bpathNumSegments(numPoints(path), isOpen(path));
+		}
+
+		// Converts a real value between 0 and 1, into a segment index and an interpolation value for that segment
+		Index indexAt(size_type path, real_t t) const {
+			Index result;
+			result.index = intern::bpathIndexAt(t, numSegments(path), result.delta);
+			return result;
+		}
+
+		Segment segmentAt(size_type path, size_type i) const {
+			assert(i < numSegments(path));
+			return intern::bpathSegment(pathData(path), numPoints(path), isOpen(path), i);
+		}
+
+		Point evalAt(size_type path, Index index) const {
+			Segment seg = segmentAt(path, index.index);
+			return ez::bezier::interpolate(seg[0], seg[1], seg[2], seg[3], index.delta);
+		}
+
+		Point evalAt(size_type path, real_t t) const {
+			return evalAt(path, indexAt(path, t));
+		}
+
+		real_t length(size_type path) const {
+			real_t total = real_t(0);
+
+			intern::bpathForEachSegment(pathData(path), numPoints(path), isOpen(path), [&total](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				total += ez::bezier::length(p0, p1, p2, p3);
+			});
+
+			return total;
+		}
+
+		// Write all the segments of the path into the output iterator, returns the number of segments written.
+		// Faster than calling segmentAt for each index, since neighbouring segments share their blended points.
+		template<typename output_iter>
+		size_type toSegments(size_type path, output_iter output) const {
+			static_assert(ez::is_output_iterator_v<output_iter>, "ez::BPathSet::toSegments requires an output iterator!");
+			static_assert(ez::is_iterator_writable_v<output_iter, Segment>, "ez::BPathSet::toSegments requires the output iterator to accept Segment values!");
+
+			intern::bpathForEachSegment(pathData(path), numPoints(path), isOpen(path), [&output](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				*output++ = Segment{ { p0, p1, p2, p3 } };
+			});
+
+			return numSegments(path);
+		}
+
+		// Same as toSegments, but writes each control of the segments into a separate output.
+		template<typename output_iter>
+		size_type toSegmentsSoA(size_type path, output_iter out0, output_iter out1, output_iter out2, output_iter out3) const {
+			static_assert(ez::is_output_iterator_v<output_iter>, "ez::BPathSet::toSegmentsSoA requires output iterators!");
+			static_assert(ez::is_iterator_writable_v<output_iter, Point>, "ez::BPathSet::toSegmentsSoA requires the output iterators to accept Point values!");
+
+			intern::bpathForEachSegment(pathData(path), numPoints(path), isOpen(path), [&](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				*out0++ = p0;
+				*out1++ = p1;
+				*out2++ = p2;
+				*out3++ = p3;
+			});
+
+			return numSegments(path);
+		}
+
+		// Copy a single path out of the set
+		BPath<vec_t> pathAt(size_type path) const {
+			const_pointer first = pathData(path);
+			return BPath<vec_t>{ first, first + numPoints(path), isOpen(path) };
+		}
+
+		// The raw buffers, for uploading or serializing the whole set at once.
+		const std::vector<Point>& pointBuffer() const {
+			return points;
+		}
+		const std::vector<size_type>& offsetBuffer() const {
+			return offsets;
+		}
+		const std::vector<std::uint8_t>& flagBuffer() const {
+			return flags;
+		}
+	private:
+		// All the points, path after path.
+		std::vector<Point> points;
+
+		// numPaths() + 1 entries, the first is always zero.
+		std::vector<size_type> offsets;
+
+		// Non-zero if the path is open
+		std::vector<std::uint8_t> flags;
+	};
+};
@@ -0,0 +1,285 @@
+#pragma once
+#include <ez/meta.hpp>
+#include <cinttypes>
+#include <cstring>
+#include <cassert>
+#include <array>
+
+#include <ez/bezier/BPath.hpp>
+#include <ez/bezier/BPathSet.hpp>
+#include <ez/bezier/intern/BezierInterpolation.hpp>
+#include <ez/bezier/intern/BezierLength.hpp>
+#include <ez/bezier/intern/BPathSegments.hpp>
+#include <ez/intern/BinaryStore.hpp>
+
+/*
+Binary layout for storing a BPathSet, designed so that it can be evaluated in place (for example from a memory mapped file).
+Everything is little endian, and each block starts on an 8 byte boundary:
+
+	header    32 bytes, see BPathStoreHeader
+	offsets   uint64[pathCount + 1], the first is always zero
+	flags     uint8[pathCount], non-zero when the path is open, padded to 8 bytes
+	points    scalar[pointCount * dimensions], tightly packed
+*/
+
+namespace ez {
+	struct BPathStoreHeader {
+		static constexpr std::array<char, 4> Magic{ { 'E', 'Z', 'B', 'P' } };
+		static constexpr std::uint16_t CurrentVersion = 1;
+		static constexpr std::size_t Size = 32;
+
+		std::array<char, 4> magic;
+		std::uint16_t version;
+		// Size in bytes of the scalar type, 4 or 8
+		std::uint8_t scalarSize;
+		// Number of scalars per point
+		std::uint8_t dimensions;
+		std::uint64_t reserved;
+		std::uint64_t pathCount;
+		std::uint64_t pointCount;
+	};
+
+	// The number of bytes writeBPathStore will output for the set
+	template<typename vec_t>
+	std::size_t bpathStoreSize(const BPathSet<vec_t>& set) {
+		using real_t = ez::vec_value_t<vec_t>;
+		constexpr std::size_t Dim = ez::vec_length_v<vec_t>;
+
+		std::size_t size = BPathStoreHeader::Size;
+		size += (set.numPaths() + 1) * sizeof(std::uint64_t);
+		size += intern::storeAlign(set.numPaths());
+		size += set.totalPoints() * Dim * sizeof(real_t);
+		return size;
+	}
+
+	// Write the set in the store layout, as a sequence of chars. Returns the number of bytes written.
+	template<typename vec_t, typename output_iter>
+	std::size_t writeBPathStore(const BPathSet<vec_t>& set, output_iter output) {
+		using real_t = ez::vec_value_t<vec_t>;
+		constexpr std::size_t Dim = ez::vec_length_v<vec_t>;
+		static_assert(sizeof(real_t) == 4 || sizeof(real_t) == 8, "ez::writeBPathStore requires float or double vectors!");
+		static_assert(ez::is_output_iterator_v<output_iter>, "ez::writeBPathStore requires an output iterator!");
+		static_assert(ez::is_iterator_writable_v<output_iter, char>, "ez::writeBPathStore requires the output iterator to accept char values!");
+
+		const std::size_t numPaths = set.numPaths();
+
+		// Header
+		for (char c : BPathStoreHeader::Magic) {
+			*output++ = c;
+		}
+		intern::storeWriteUInt(BPathStoreHeader::CurrentVersion, 2, output);
+		intern::storeWriteUInt(sizeof(real_t), 1, output);
+		intern::storeWriteUInt(Dim, 1, output);
+		intern::storeWriteUInt(0, 8, output);
+		intern::storeWriteUInt(numPaths, 8, output);
+		intern::storeWriteUInt(set.totalPoints(), 8, output);
+
+		for (std::size_t offset : set.offsetBuffer()) {
+			intern::storeWriteUInt(offset, 8, output);
+		}
+
+		for (std::uint8_t flag : set.flagBuffer()) {
+			*output++ = static_cast<char>(flag);
+		}
+		for (std::size_t i = numPaths; i < intern::storeAlign(numPaths); ++i) {
+			*output++ = char(0);
+		}
+
+		for (const vec_t& point : set.pointBuffer()) {
+			for (std::size_t i = 0; i < Dim; ++i) {
+				intern::storeWriteReal(point[static_cast<int>(i)], output);
+			}
+		}
+
+		return bpathStoreSize(set);
+	}
+
+	// Write a single path as a set containing one path.
+	template<typename vec_t, typename Alloc, typename output_iter>
+	std::size_t writeBPathStore(const BPath<vec_t, Alloc>& path, output_iter output) {
+		BPathSet<vec_t> set;
+		set.addPath(path);
+		return writeBPathStore(set, output);
+	}
+
+	/*
+	Read only view of a BPathSet in the store layout.
+	Nothing is copied, the paths are evaluated directly from the buffer, so the buffer must outlive the view.
+	The buffer must be 8 byte aligned, which memory mapped files always are.
+	*/
+	template<typename vec_t>
+	class BPathSetView {
+	public:
+		using value_type = vec_t;
+		using real_t = ez::vec_value_t<vec_t>;
+		static constexpr std::size_t Dim = ez::vec_length_v<vec_t>;
+
+		static_assert(std::is_floating_point_v<real_t>, "ez::BPathSetView requires floating point type!");
+
+		using Point = value_type;
+		using size_type = std::size_t;
+		using const_pointer = const value_type*;
+
+		using Segment = std::array<Point, 4>;
+		using Index = typename BPath<vec_t>::Index;
+
+		BPathSetView()
+			: pathCount(0)
+			, offsets(nullptr)
+			, flags(nullptr)
+			, points(nullptr)
+		{}
+
+		BPathSetView(const void* data, std::size_t size)
+			: BPathSetView()
+		{
+			assign(data, size);
+		}
+
+		// Point the view at a new buffer. Returns false and leaves the view empty if the buffer is not a valid store for vec_t.
+		bool assign(const void* data, std::size_t size) {
+			*this = BPathSetView{};
+
+			// The view reinterprets the buffer directly, so the host must match the layout.
+			if (!intern::hostIsLittleEndian() || sizeof(vec_t) != sizeof(real_t) * Dim) {
+				return false;
+			}
+			if (data == nullptr || size < BPathStoreHeader::Size || (reinterpret_cast<std::uintptr_t>(data) % 8) != 0) {
+				return false;
+			}
+
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			BPathStoreHeader header = readHeader(bytes);
+			if (header.magic != BPathStoreHeader::Magic ||
+				header.version != BPathStoreHeader::CurrentVersion ||
+				header.scalarSize != sizeof(real_t) ||
+				header.dimensions != Dim)
+			{
+				return false;
+			}
+
+			std::size_t offsetsStart = BPathStoreHeader::Size;
+			std::size_t flagsStart = offsetsStart + (header.pathCount + 1) * sizeof(std::uint64_t);
+			std::size_t pointsStart = flagsStart + intern::storeAlign(header.pathCount);
+			std::size_t total = pointsStart + header.pointCount * sizeof(vec_t);
+			if (header.pathCount >= size || header.pointCount >= size || total > size) {
+				return false;
+			}
+
+			const std::uint64_t* offs = reinterpret_cast<const std::uint64_t*>(bytes + offsetsStart);
+			if (offs[0] != 0 || offs[header.pathCount] != header.pointCount) {
+				return false;
+			}
+			// Only the offsets are checked, the points are never touched until they are evaluated.
+			for (std::uint64_t i = 0; i < header.pathCount; ++i) {
+				if (offs[i] > offs[i + 1]) {
+					return false;
+				}
+			}
+
+			pathCount = static_cast<size_type>(header.pathCount);
+			offsets = offs;
+			flags = bytes + flagsStart;
+			points = reinterpret_cast<const_pointer>(bytes + pointsStart);
+			return true;
+		}
+
+		static BPathStoreHeader readHeader(const unsigned char* bytes) {
+			BPathStoreHeader header;
+			std::memcpy(header.magic.data(), bytes, 4);
+			header.version = static_cast<std::uint16_t>(intern::storeReadUInt(bytes + 4, 2));
+			header.scalarSize = bytes[6];
+			header.dimensions = bytes[7];
+			header.reserved = intern::storeReadUInt(bytes + 8, 8);
+			header.pathCount = intern::storeReadUInt(bytes + 16, 8);
+			header.pointCount = intern::storeReadUInt(bytes + 24, 8);
+			return header;
+		}
+
+		bool empty() const {
+			return pathCount == 0;
+		}
+		size_type size() const {
+			return pathCount;
+		}
+		size_type numPaths() const {
+			return pathCount;
+		}
+
+		size_type numPoints(size_type path) const {
+			assert(path < numPaths());
+			return static_cast<size_type>(offsets[path + 1] - offsets[path]);
+		}
+
+		const_pointer pathData(size_type path) const {
+			assert(path < numPaths());
+			return points + offsets[path];
+		}
+
+		bool isOpen(size_type path) const {
+			assert(path < numPaths());
+			return flags[path] != 0;
+		}
+		bool isClosed(size_type path) const {
+			return !isOpen(path);
+		}
+
+		size_type numSegments(size_type path) const {
+			return intern::bpathNumSegments(numPoints(path), isOpen(path));
+		}
+
+		// Converts a real value between 0 and 1, into a segment index and an interpolation value for that segment
+		Index indexAt(size_type path, real_t t) const {
+			Index result;
+			result.index = intern::bpathIndexAt(t, numSegments(path), result.delta);
+			return result;
+		}
+
+		Segment segmentAt(size_type path, size_type i) const {
+			assert(i < numSegments(path));
+			return intern::bpathSegment(pathData(path), numPoints(path), isOpen(path), i);
+		}
+
+		Point evalAt(size_type path, Index index) const {
+			Segment seg = segmentAt(path, index.index);
+			return ez::bezier::interpolate(seg[0], seg[1], seg[2], seg[3], index.delta);
+		}
+
+		Point evalAt(size_type path, real_t t) const {
+			return evalAt(path, indexAt(path, t));
+		}
+
+		real_t length(size_type path) const {
+			real_t total = real_t(0);
+
+			intern::bpathForEachSegment(pathData(path), numPoints(path), isOpen(path), [&total](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				total += ez::bezier::length(p0, p1, p2, p3);
+			});
+
+			return total;
+		}
+
+		template<typename output_iter>
+		size_type toSegments(size_type path, output_iter output) const {
+			static_assert(ez::is_output_iterator_v<output_iter>, "ez::BPathSetView::toSegments requires an output iterator!");
+			static_assert(ez::is_iterator_writable_v<output_iter, Segment>, "ez::BPathSetView::toSegments requires the output iterator to accept Segment values!");
+
+			intern::bpathForEachSegment(pathData(path), numPoints(path), isOpen(path), [&output](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				*output++ = Segment{ { p0, p1, p2, p3 } };
+			});
+
+			return numSegments(path);
+		}
+
+		// Copy a single path out of the view
+		BPath<vec_t> pathAt(size_type path) const {
+			const_pointer first = pathData(path);
+			return BPath<vec_t>{ first, first + numPoints(path), isOpen(path) };
+		}
+	private:
+		size_type pathCount;
+		const std::uint64_t* offsets;
+		const unsigned char* flags;
+		const_pointer points;
+	};
+};
@@ -0,0 +1,343 @@
+#pragma once
+#include <ez/meta.hpp>
+#include <cinttypes>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+#include <array>
+
+#include <ez/bezier/BPath.hpp>
+#include <ez/bezier/intern/BezierInterpolation.hpp>
+#include <ez/bezier/intern/BezierLength.hpp>
+#include <ez/bezier/intern/BPathSegments.hpp>
+
+namespace ez {
+	/*
+	A BPath where each control can be marked as a corner.
+	Smooth controls behave exactly as in BPath, corner controls are interpolated by the curve with a sharp join.
+	This avoids having to duplicate points in a BPath to emulate corners.
+
+	The cubic segments are kept in a precomputed table, moving a control only rebuilds the segments next to it.
+	Structural changes (adding, removing, toggling corners) rebuild the whole table.
+	*/
+	template<typename vec_t>
+	class CornerPath {
+	public:
+		using value_type = vec_t;
+		using real_t = ez::vec_value_t<vec_t>;
+
+		static_assert(std::is_floating_point_v<real_t>, "ez::CornerPath requires floating point type!");
+
+		using Point = value_type;
+
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		struct Control {
+			bool corner;
+			vec_t position;
+		};
+
+		using Container = std::vector<Control>;
+		using const_iterator = typename Container::const_iterator;
+
+		using Segment = std::array<Point, 4>;
+		using Index = typename BPath<vec_t>::Index;
+
+		~CornerPath() = default;
+		CornerPath(const CornerPath&) = default;
+		CornerPath(CornerPath&&) noexcept = default;
+		CornerPath& operator=(const CornerPath&) = default;
+		CornerPath& operator=(CornerPath&&) noexcept = default;
+
+		CornerPath()
+			: open(true)
+		{}
+
+		template<typename Iter>
+		CornerPath(Iter first, Iter last, bool _open = true)
+			: open(_open)
+			, controls(first, last)
+		{
+			static_assert(ez::is_input_iterator_v<Iter>, "ez::CornerPath::CornerPath requires an input iterator!");
+			rebuild();
+		}
+
+		// Converts a real value between 0 and 1, into a segment index and an interpolation value for that segment
+		Index indexAt(real_t t) const {
+			Index result;
+			result.index = intern::bpathIndexAt(t, numSegments(), result.delta);
+			return result;
+		}
+
+		const Segment& segmentAt(size_type i) const {
+			assert(i < numSegments());
+			return segments[i];
+		}
+
+		size_type numSegments() const {
+			return segments.size();
+		}
+
+		// The precomputed segment table
+		const Segment* segmentData() const {
+			return segments.data();
+		}
+
+		Point evalAt(Index index) const {
+			const Segment& seg = segmentAt(index.index);
+			return ez::bezier::interpolate(seg[0], seg[1], seg[2], seg[3], index.delta);
+		}
+
+		Point evalAt(real_t t) const {
+			return evalAt(indexAt(t));
+		}
+
+		real_t length() const {
+			real_t total = real_t(0);
+			for (const Segment& seg : segments) {
+				total += ez::bezier::length(seg[0], seg[1], seg[2], seg[3]);
+			}
+			return total;
+		}
+
+		const Control& operator[](size_type i) const {
+			assert(i < controls.size());
+			return controls[i];
+		}
+		const Control& at(size_type i) const {
+			return controls.at(i);
+		}
+
+		// Move a single control, only the neighbouring segments are recalculated.
+		void setPosition(size_type i, const vec_t& position) {
+			assert(i < controls.size());
+			controls[i].position = position;
+			update(i);
+		}
+		void setCorner(size_type i, bool corner) {
+			assert(i < controls.size());
+			if (controls[i].corner != corner) {
+				controls[i].corner = corner;
+				rebuild();
+			}
+		}
+		void setControl(size_type i, const Control& control) {
+			assert(i < controls.size());
+			if (controls[i].corner != control.corner) {
+				controls[i] = control;
+				rebuild();
+			}
+			else {
+				setPosition(i, control.position);
+			}
+		}
+
+		template<typename Iter>
+		void assign(Iter first, Iter last) {
+			static_assert(ez::is_input_iterator_v<Iter>, "ez::CornerPath::assign requires an input iterator!");
+			controls.assign(first, last);
+			rebuild();
+		}
+
+		void append(const vec_t& position, bool corner = false) {
+			push_back(Control{ corner, position });
+		}
+		void push_back(const Control& control) {
+			controls.push_back(control);
+			rebuild();
+		}
+		void pop_back() {
+			controls.pop_back();
+			rebuild();
+		}
+		void insert(size_type i, const Control& control) {
+			assert(i <= controls.size());
+			controls.insert(controls.begin() + i, control);
+			rebuild();
+		}
+		void erase(size_type i) {
+			assert(i < controls.size());
+			controls.erase(controls.begin() + i);
+			rebuild();
+		}
+
+		void clear() {
+			controls.clear();
+			rebuild();
+		}
+
+		bool empty() const {
+			return controls.empty();
+		}
+		size_type size() const {
+			return controls.size();
+		}
+		size_type numPoints() const {
+			return controls.size();
+		}
+
+		const_iterator begin() const {
+			return controls.begin();
+		}
+		const_iterator end() const {
+			return controls.end();
+		}
+
+		bool isOpen() const {
+			return open;
+		}
+		bool isClosed() const {
+			return !open;
+		}
+		void setOpen(bool value) {
+			if (open != value) {
+				open = value;
+				rebuild();
+			}
+		}
+		void setClosed(bool value) {
+			setOpen(!value);
+		}
+	private:
+		bool open;
+		Container controls;
+
+		// The points the quadratic B-spline is built over. Smooth controls add one blended point, corners add their position twice.
+		std::vector<Point> knots;
+
+		// Index of the first knot of each control, in knot order. Has numPoints() + 1 entries.
+		// Closed paths start at control 1, so that the segments line up with BPath.
+		std::vector<size_type> knotStart;
+
+		std::vector<Segment> segments;
+
+		size_type controlAt(size_type order) const noexcept {
+			return open ? order : (order + 1 == controls.size() ? 0 : order + 1);
+		}
+		size_type orderOf(size_type control) const noexcept {
+			return open ? control : (control == 0 ? controls.size() - 1 : control - 1);
+		}
+
+		// Calculate the knot(s) of a control, returns the number written
+		size_type controlKnots(size_type i, Point* out) const {
+			static constexpr real_t b = real_t{ 9 } / real_t{ 12 };
+			static constexpr real_t a = (1.0 - b) / 2.0;
+
+			const size_type count = controls.size();
+			const Control& control = controls[i];
+
+			if (control.corner) {
+				out[0] = control.position;
+				out[1] = control.position;
+				return 2;
+			}
+			else if (open && (i == 0 || i + 1 == count)) {
+				out[0] = control.position;
+				return 1;
+			}
+			else {
+				size_type prev = i == 0 ? count - 1 : i - 1;
+				size_type next = i + 1 == count ? 0 : i + 1;
+				out[0] = controls[prev].position * a + control.position * b + controls[next].position * a;
+				return 1;
+			}
+		}
+
+		Segment knotSegment(size_type k) const {
+			static constexpr real_t lower(8 / 12.0);
+			static constexpr real_t upper = real_t(1) - lower;
+
+			const size_type count = knots.size();
+			const Point& p0 = knots[k % count];
+			const Point& p1 = knots[(k + 1) % count];
+			const Point& p2 = knots[(k + 2) % count];
+
+			Segment seg;
+			seg[0] = ez::bezier::interpolate(p0, p1, real_t{ 0.5 });
+			seg[3] = ez::bezier::interpolate(p1, p2, real_t{ 0.5 });
+
+			seg[1] = ez::bezier::interpolate(seg[0], p1, lower);
+			seg[2] = ez::bezier::interpolate(p1, seg[3], upper);
+			return seg;
+		}
+
+		void rebuild() {
+			knots.clear();
+			knotStart.clear();
+			segments.clear();
+
+			const size_type count = controls.size();
+			// Same minimum as BPath
+			if (count <= 3) {
+				return;
+			}
+
+			std::array<Point, 2> tmp;
+			for (size_type order = 0; order < count; ++order) {
+				knotStart.push_back(knots.size());
+				size_type written = controlKnots(controlAt(order), tmp.data());
+				knots.insert(knots.end(), tmp.begin(), tmp.begin() + written);
+			}
+			knotStart.push_back(knots.size());
+
+			size_type numSegs = open ? knots.size() - 2 : knots.size();
+			segments.reserve(numSegs);
+			for (size_type k = 0; k < numSegs; ++k) {
+				segments.push_back(knotSegment(k));
+			}
+		}
+
+		// Recalculate the knots and segments affected by moving control 'i'
+		void update(size_type i) {
+			if (segments.empty()) {
+				return;
+			}
+
+			const difference_type count = static_cast<difference_type>(controls.size());
+			const difference_type numKnots = static_cast<difference_type>(knots.size());
+			const difference_type order = static_cast<difference_type>(orderOf(i));
+
+			// The control and its neighbours have blends that include the moved position.
+			difference_type first = order - 1, last = order + 1;
+			if (open) {
+				first = std::max(first, difference_type(0));
+				last = std::min(last, count - 1);
+			}
+
+			// Knot range, unwrapped so that it may go below zero or past the end for closed paths.
+			difference_type knotFirst = 0, knotLast = 0;
+			std::array<Point, 2> tmp;
+			for (difference_type o = first; o <= last; ++o) {
+				difference_type wrapped = (o + count) % count;
+				difference_type shift = o < 0 ? -numKnots : (o >= count ? numKnots : 0);
+				difference_type start = static_cast<difference_type>(knotStart[wrapped]);
+
+				size_type written = controlKnots(controlAt(static_cast<size_type>(wrapped)), tmp.data());
+				std::copy(tmp.begin(), tmp.begin() + written, knots.begin() + start);
+
+				if (o == first) {
+					knotFirst = start + shift;
+				}
+				knotLast = start + shift + static_cast<difference_type>(written) - 1;
+			}
+
+			// Segment 's' uses knots s, s+1 and s+2
+			difference_type segFirst = knotFirst - 2, segLast = knotLast;
+			const difference_type numSegs = static_cast<difference_type>(segments.size());
+			if (open) {
+				segFirst = std::max(segFirst, difference_type(0));
+				segLast = std::min(segLast, numSegs - 1);
+			}
+			else if (segLast - segFirst + 1 >= numSegs) {
+				segFirst = 0;
+				segLast = numSegs - 1;
+			}
+
+			for (difference_type s = segFirst; s <= segLast; ++s) {
+				size_type wrapped = static_cast<size_type>((s + numSegs) % numSegs);
+				segments[wrapped] = knotSegment(wrapped);
+			}
+		}
+	};
+};
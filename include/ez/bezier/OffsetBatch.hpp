@@ -0,0 +1,58 @@
+#pragma once
+#include <ez/meta.hpp>
+#include <cinttypes>
+#include <cassert>
+#include <array>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <glm/vec2.hpp>
+
+#include <ez/bezier/Bezier.hpp>
+#include <ez/interpolate/Execution.hpp>
+
+namespace ez::bezier {
+	/*
+	Offset 'count' cubic curves into one contiguous buffer, the same as calling pixelOffset on each curve in order.
+	'offsets' is resized to count + 1, the points of curve i are out[offsets[i]] up to out[offsets[i + 1]].
+
+	Each block of the execution policy offsets its curves into its own scratch buffer, then after a prefix sum over the counts
+	the blocks copy their buffers to their place in 'out'. Every curve is offset once, so with a single thread this is about as fast as a loop of pixelOffset calls.
+	*/
+	template<typename T, typename Policy>
+	void pixelOffsetBatch(const std::array<glm::tvec2<T>, 4>* curves, std::size_t count, T delta, std::vector<glm::tvec2<T>>& out, std::vector<std::size_t>& offsets, const Policy& policy) {
+		static_assert(std::is_floating_point_v<T>, "ez::bezier::pixelOffsetBatch requires floating point value types!");
+		static_assert(ez::is_execution_policy_v<Policy>, "ez::bezier::pixelOffsetBatch requires an execution policy!");
+
+		offsets.resize(count + 1);
+		offsets[0] = 0;
+
+		std::vector<std::vector<glm::tvec2<T>>> scratch(ez::intern::parallelBlocks(policy, count));
+
+		ez::intern::parallelForBlocks(policy, count, [&](std::size_t block, std::size_t first, std::size_t last) {
+			std::vector<glm::tvec2<T>>& points = scratch[block];
+			for (std::size_t i = first; i < last; ++i) {
+				const auto& curve = curves[i];
+				offsets[i + 1] = static_cast<std::size_t>(bezier::pixelOffset(curve[0], curve[1], curve[2], curve[3], delta, std::back_inserter(points)));
+			}
+		});
+
+		for (std::size_t i = 0; i < count; ++i) {
+			offsets[i + 1] += offsets[i];
+		}
+		out.resize(offsets[count]);
+
+		ez::intern::parallelForBlocks(policy, count, [&](std::size_t block, std::size_t first, std::size_t last) {
+			std::vector<glm::tvec2<T>>& points = scratch[block];
+			assert(points.size() == offsets[last] - offsets[first]);
+
+			std::copy(points.begin(), points.end(), out.begin() + static_cast<std::ptrdiff_t>(offsets[first]));
+			// Free each block as soon as it is copied
+			std::vector<glm::tvec2<T>>().swap(points);
+		});
+	}
+	template<typename T>
+	void pixelOffsetBatch(const std::array<glm::tvec2<T>, 4>* curves, std::size_t count, T delta, std::vector<glm::tvec2<T>>& out, std::vector<std::size_t>& offsets) {
+		pixelOffsetBatch(curves, count, delta, out, offsets, ez::execution::seq);
+	}
+};
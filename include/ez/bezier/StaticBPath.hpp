@@ -0,0 +1,159 @@
+#pragma once
+#include <ez/meta.hpp>
+#include <cinttypes>
+#include <cassert>
+#include <array>
+
+#include <ez/bezier/BPath.hpp>
+#include <ez/bezier/intern/BezierInterpolation.hpp>
+#include <ez/bezier/intern/BezierLength.hpp>
+#include <ez/bezier/intern/BPathSegments.hpp>
+
+namespace ez {
+	/*
+	A BPath with a fixed number of points, stored inline.
+	Evaluation is constexpr, so paths known at compile time (easing curves, camera rails) can be folded by the compiler.
+	*/
+	template<typename vec_t, std::size_t N>
+	class StaticBPath {
+	public:
+		using value_type = vec_t;
+		using real_t = ez::vec_value_t<vec_t>;
+
+		static_assert(std::is_floating_point_v<real_t>, "ez::StaticBPath requires floating point type!");
+
+		using Point = value_type;
+
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+
+		using reference = value_type&;
+		using pointer = value_type*;
+		using const_reference = const value_type&;
+		using const_pointer = const value_type*;
+
+		using Container = std::array<Point, N>;
+
+		using iterator = typename Container::iterator;
+		using const_iterator = typename Container::const_iterator;
+
+		using Segment = std::array<Point, 4>;
+		using Index = typename BPath<vec_t>::Index;
+
+		constexpr StaticBPath()
+			: open(true)
+			, points{}
+		{}
+
+		constexpr StaticBPath(const Container& _points, bool _open = true)
+			: open(_open)
+			, points(_points)
+		{}
+
+		// Converts a real value between 0 and 1, into a segment index and an interpolation value for that segment
+		constexpr Index indexAt(real_t t) const {
+			Index result{};
+			result.index = intern::bpathIndexAt(t, numSegments(), result.delta);
+			return result;
+		}
+
+		constexpr Segment segmentAt(size_type i) const {
+			assert(i < numSegments());
+			return intern::bpathSegment(points.data(), N, open, i);
+		}
+
+		constexpr size_type numSegments() const {
+			return intern::bpathNumSegments(N, open);
+		}
+
+		constexpr Point evalAt(Index index) const {
+			Segment seg = segmentAt(index.index);
+			return ez::bezier::interpolate(seg[0], seg[1], seg[2], seg[3], index.delta);
+		}
+
+		constexpr Point evalAt(real_t t) const {
+			return evalAt(indexAt(t));
+		}
+
+		real_t length() const {
+			real_t total = real_t(0);
+
+			intern::bpathForEachSegment(points.data(), N, open, [&total](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				total += ez::bezier::length(p0, p1, p2, p3);
+			});
+
+			return total;
+		}
+
+		// Write all the segments of the path into the output iterator, returns the number of segments written.
+		template<typename output_iter>
+		size_type toSegments(output_iter output) const {
+			static_assert(ez::is_output_iterator_v<output_iter>, "ez::StaticBPath::toSegments requires an output iterator!");
+			static_assert(ez::is_iterator_writable_v<output_iter, Segment>, "ez::StaticBPath::toSegments requires the output iterator to accept Segment values!");
+
+			intern::bpathForEachSegment(points.data(), N, open, [&output](size_type, const Point& p0, const Point& p1, const Point& p2, const Point& p3) {
+				*output++ = Segment{ { p0, p1, p2, p3 } };
+			});
+
+			return numSegments();
+		}
+
+		constexpr reference operator[](size_type i) {
+			assert(i < N);
+			return points[i];
+		}
+		constexpr const_reference operator[](size_type i) const {
+			assert(i < N);
+			return points[i];
+		}
+
+		constexpr pointer data() {
+			return points.data();
+		}
+		constexpr const_pointer data() const {
+			return points.data();
+		}
+
+		static constexpr size_type size() {
+			return N;
+		}
+		static constexpr size_type numPoints() {
+			return N;
+		}
+
+		constexpr iterator begin() {
+			return points.begin();
+		}
+		constexpr iterator end() {
+			return points.end();
+		}
+
+		constexpr const_iterator begin() const {
+			return points.begin();
+		}
+		constexpr const_iterator end() const {
+			return points.end();
+		}
+
+		constexpr bool isOpen() const {
+			return open;
+		}
+		constexpr bool isClosed() const {
+			return !open;
+		}
+		constexpr void setOpen(bool value) {
+			open = value;
+		}
+		constexpr void setClosed(bool value) {
+			open = !value;
+		}
+
+		// Copy into a dynamically sized path
+		BPath<vec_t> toBPath() const {
+			return BPath<vec_t>{ points.begin(), points.end(), open };
+		}
+	private:
+		bool open;
+		Container points;
+	};
+};
@@ -0,0 +1,289 @@
+#pragma once
+#include <ez/meta.hpp>
+#include <cinttypes>
+#include <cassert>
+#include <cmath>
+#include <array>
+#include <glm/vec2.hpp>
+#include <glm/geometric.hpp>
+#include <ez/math/constants.hpp>
+
+#include <ez/bezier/Bezier.hpp>
+
+namespace ez::bezier {
+	enum class JoinStyle {
+		Miter,
+		Round,
+		Bevel
+	};
+
+	enum class CapStyle {
+		Butt,
+		Round,
+		Square
+	};
+
+	// The number of points written by stroke.
+	// Open paths make a single contour, closed paths make two, the first 'firstContour' points are the outline on the left of the path.
+	struct StrokeCount {
+		std::ptrdiff_t count = 0;
+		std::ptrdiff_t firstContour = 0;
+	};
+
+	namespace intern {
+		// Streams the offsets, joins and caps of one path into the output, as a chain of cubic controls.
+		template<typename T, typename output_iter>
+		struct Stroker {
+			using vec_t = glm::tvec2<T>;
+			using Segment = std::array<vec_t, 4>;
+
+			T halfWidth;
+			JoinStyle join;
+			CapStyle cap;
+			T miterLimit;
+			output_iter& output;
+			std::ptrdiff_t count;
+
+			static vec_t left(const vec_t& v) {
+				return vec_t{ -v.y, v.x };
+			}
+			static T cross(const vec_t& lh, const vec_t& rh) {
+				return lh.x * rh.y - lh.y * rh.x;
+			}
+
+			// The direction at the ends of a segment, skipping controls that sit on top of the end point.
+			static bool startTangent(const Segment& seg, vec_t& tangent) {
+				for (int i = 1; i < 4; ++i) {
+					vec_t diff = seg[i] - seg[0];
+					if (glm::dot(diff, diff) > ez::epsilon<T>()) {
+						tangent = glm::normalize(diff);
+						return true;
+					}
+				}
+				return false;
+			}
+			static bool endTangent(const Segment& seg, vec_t& tangent) {
+				for (int i = 2; i >= 0; --i) {
+					vec_t diff = seg[3] - seg[i];
+					if (glm::dot(diff, diff) > ez::epsilon<T>()) {
+						tangent = glm::normalize(diff);
+						return true;
+					}
+				}
+				return false;
+			}
+
+			// The offset uses the normals at the ends of the segment, which are undefined when an inner control sits on its end point (like at the corners of a CornerPath).
+			// Moving the control a tiny step toward the first distinct control gives the end the limiting tangent, without visibly changing the curve.
+			static void separateEnds(Segment& seg) {
+				constexpr T step = T(1e-3);
+				auto distinct = [](const vec_t& lh, const vec_t& rh) {
+					return glm::dot(lh - rh, lh - rh) > ez::epsilon<T>();
+				};
+
+				if (!distinct(seg[1], seg[0])) {
+					int i = distinct(seg[2], seg[0]) ? 2 : 3;
+					seg[1] += (seg[i] - seg[1]) * step;
+				}
+				if (!distinct(seg[2], seg[3])) {
+					int i = distinct(seg[1], seg[3]) ? 1 : 0;
+					seg[2] += (seg[i] - seg[2]) * step;
+				}
+			}
+
+			void write(const vec_t& point) {
+				*output++ = point;
+				++count;
+			}
+
+			// A straight cubic from the current point
+			void lineTo(const vec_t& from, const vec_t& to) {
+				write(from + (to - from) * (T(1) / T(3)));
+				write(from + (to - from) * (T(2) / T(3)));
+				write(to);
+			}
+
+			// Circular arc from the current point at center + dir * radius, turning counter clockwise for positive angles.
+			// Split into pieces of at most a quarter turn, so each cubic stays close to the circle.
+			void arcTo(const vec_t& center, vec_t dir, T angle, T radius) {
+				constexpr T quarterTurn = T(1.57079632679489661923);
+				int pieces = std::max(1, static_cast<int>(std::ceil(std::abs(angle) / quarterTurn - T(1e-4))));
+				T step = angle / T(pieces);
+				T k = T(4) / T(3) * std::tan(step * T(0.25));
+				T c = std::cos(step), s = std::sin(step);
+
+				for (int i = 0; i < pieces; ++i) {
+					vec_t next{ dir.x * c - dir.y * s, dir.x * s + dir.y * c };
+					write(center + (dir + left(dir) * k) * radius);
+					write(center + (next - left(next) * k) * radius);
+					write(center + next * radius);
+					dir = next;
+				}
+			}
+
+			// Connect the offset of the end of one segment to the offset of the start of the next, around the point 'pivot'.
+			void joinAt(const vec_t& pivot, const vec_t& t0, const vec_t& t1) {
+				vec_t n0 = left(t0), n1 = left(t1);
+				T turn = cross(t0, t1);
+				T cosine = glm::dot(t0, t1);
+				if (cosine > T(1) - T(1e-6)) {
+					// Smooth, the offsets already meet
+					return;
+				}
+
+				vec_t from = pivot + n0 * halfWidth;
+				vec_t to = pivot + n1 * halfWidth;
+
+				if (turn > T(0)) {
+					// Inner side of the turn, going through the pivot keeps the winding consistent where the offsets overlap.
+					lineTo(from, pivot);
+					lineTo(pivot, to);
+					return;
+				}
+
+				switch (join) {
+				case JoinStyle::Miter: {
+					vec_t half = n0 + n1;
+					T len2 = glm::dot(half, half);
+					// The miter length over the half width is 2 / |n0 + n1|
+					if (len2 > ez::epsilon<T>() && T(4) <= miterLimit * miterLimit * len2) {
+						vec_t tip = pivot + half * (T(2) * halfWidth / len2);
+						lineTo(from, tip);
+						lineTo(tip, to);
+						break;
+					}
+					lineTo(from, to);
+					break;
+				}
+				case JoinStyle::Round:
+					// Clockwise, this is the outer side of a right turn
+					arcTo(pivot, n0, -std::abs(std::atan2(turn, cosine)), halfWidth);
+					break;
+				case JoinStyle::Bevel:
+				default:
+					lineTo(from, to);
+					break;
+				}
+			}
+
+			// Cap the end of a side at 'end', going from the left offset to the right offset.
+			void capAt(const vec_t& end, const vec_t& tangent) {
+				vec_t n = left(tangent);
+				vec_t from = end + n * halfWidth;
+				vec_t to = end - n * halfWidth;
+
+				switch (cap) {
+				case CapStyle::Round:
+					arcTo(end, n, -T(3.14159265358979323846), halfWidth);
+					break;
+				case CapStyle::Square: {
+					vec_t ext = tangent * halfWidth;
+					lineTo(from, from + ext);
+					lineTo(from + ext, to + ext);
+					lineTo(to + ext, to);
+					break;
+				}
+				case CapStyle::Butt:
+				default:
+					lineTo(from, to);
+					break;
+				}
+			}
+
+			/*
+			Offset every segment of the path to its left, in order or in reverse.
+			'startTan' and 'endTan' are set to the tangents at the start and end of the side.
+			Returns false if every segment is degenerate.
+			*/
+			template<typename Path>
+			bool side(const Path& path, bool reversed, bool writeStart, vec_t& first, vec_t& startTan, vec_t& endTan) {
+				const std::size_t numSegments = path.numSegments();
+				bool started = false;
+
+				for (std::size_t k = 0; k < numSegments; ++k) {
+					Segment seg;
+					{
+						auto source = path.segmentAt(reversed ? numSegments - 1 - k : k);
+						for (int i = 0; i < 4; ++i) {
+							seg[i] = source[reversed ? 3 - i : i];
+						}
+					}
+
+					vec_t t0, t1;
+					if (!startTangent(seg, t0) || !endTangent(seg, t1)) {
+						continue;
+					}
+					separateEnds(seg);
+
+					if (!started) {
+						first = seg[0];
+						startTan = t0;
+						if (writeStart) {
+							write(seg[0] + left(t0) * halfWidth);
+						}
+						started = true;
+					}
+					else {
+						joinAt(seg[0], endTan, t0);
+					}
+
+					// Pass the iterator by reference, so the output advances past the offset
+					count += simplePixelOffset<4, T, output_iter&>(seg, halfWidth, T(0.5), output);
+					endTan = t1;
+				}
+				return started;
+			}
+		};
+	};
+
+	/*
+	Outline the stroke of a path, for filling with the non zero rule.
+	The output is a chain of cubic controls like pixelOffset: the first point, then three more for each cubic.
+	Each contour ends on its first point.
+
+	Joins are added wherever the neighbouring segments meet at an angle, on the inner side of a turn the outline goes through the path itself.
+	Miter joins longer than miterLimit times the half width fall back to bevel joins.
+	Works with any path type that has numSegments, segmentAt and isOpen, such as BPath or CornerPath.
+	*/
+	template<typename Path, typename output_iter>
+	StrokeCount stroke(const Path& path, typename Path::real_t width, JoinStyle join, CapStyle cap, output_iter output, typename Path::real_t miterLimit = 4) {
+		using T = typename Path::real_t;
+		using vec_t = glm::tvec2<T>;
+		static_assert(std::is_floating_point_v<T>, "ez::bezier::stroke requires floating point value types!");
+		static_assert(std::is_same_v<typename Path::value_type, vec_t>, "ez::bezier::stroke requires a two dimensional path!");
+		static_assert(ez::is_output_iterator_v<output_iter>, "ez::bezier::stroke requires an output iterator as its last argument!");
+		static_assert(ez::is_iterator_writable_v<output_iter, vec_t>, "ez::bezier::stroke requires the output iterator to accept vec2 values!");
+		assert(width > T(0));
+
+		intern::Stroker<T, output_iter> stroker{ width * T(0.5), join, cap, miterLimit, output, 0 };
+		StrokeCount result;
+
+		vec_t first, startTan, endTan;
+		if (!stroker.side(path, false, true, first, startTan, endTan)) {
+			return result;
+		}
+
+		if (path.isOpen()) {
+			vec_t last = path.segmentAt(path.numSegments() - 1)[3];
+			stroker.capAt(last, endTan);
+
+			vec_t unused, backStart, backEnd;
+			stroker.side(path, true, false, unused, backStart, backEnd);
+			stroker.capAt(first, backEnd);
+
+			result.count = stroker.count;
+			result.firstContour = stroker.count;
+		}
+		else {
+			stroker.joinAt(first, endTan, startTan);
+			result.firstContour = stroker.count;
+
+			vec_t backFirst, backStart, backEnd;
+			stroker.side(path, true, true, backFirst, backStart, backEnd);
+			stroker.joinAt(backFirst, backEnd, backStart);
+
+			result.count = stroker.count;
+		}
+		return result;
+	}
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include <ez/meta.hpp>
+#include <cstddef>
+#include <array>
+
+// Shared B-spline to bezier conversion used by the path types.
+// The functions only take a pointer and a count, so they work on any contiguous point storage.
+
+namespace ez::intern {
+	// The number of cubic segments for a path with 'count' control points.
+	constexpr std::size_t bpathNumSegments(std::size_t count, bool open) noexcept {
+		if (count > 3) {
+			return open ? count - std::size_t(2) : count;
+		}
+		else {
+			return 0;
+		}
+	}
+
+	// Converts a real value between 0 and 1, into a segment index and an interpolation value for that segment
+	template<typename real_t>
+	constexpr std::size_t bpathIndexAt(real_t t, std::size_t numSegments, real_t& delta) noexcept {
+		t = t < real_t(0) ? real_t(0) : (t > real_t(0.999999) ? real_t(0.999999) : t);
+
+		real_t scaled = t * static_cast<real_t>(numSegments);
+		std::size_t index = static_cast<std::size_t>(scaled);
+		delta = scaled - static_cast<real_t>(index);
+
+		return index;
+	}
+
+	// Calculates the cubic bezier controls of segment 'i' of a uniform B-spline path.
+	template<typename vec_t>
+	constexpr std::array<vec_t, 4> bpathSegment(const vec_t* points, std::size_t count, bool open, std::size_t i) {
+		using real_t = ez::vec_value_t<vec_t>;
+
+		constexpr real_t lower(8 / 12.0);
+		constexpr real_t upper = real_t(1) - lower;
+
+		constexpr real_t b = real_t{ 9 } / real_t{ 12 };
+		constexpr real_t a = (1.0 - b) / 2.0;
+
+		std::array<vec_t, 4> seg{};
+		vec_t p0{}, p1{}, p2{};
+
+		if (!open) {
+			auto wrap = [count](std::size_t j) {
+				return j >= count ? j - count : j;
+			};
+			std::size_t
+				i1 = wrap(i + 1),
+				i2 = wrap(i + 2),
+				i3 = wrap(i + 3),
+				i4 = wrap(i + 4);
+
+			p0 = points[i ] * a + points[i1] * b + points[i2] * a;
+			p1 = points[i1] * a + points[i2] * b + points[i3] * a;
+			p2 = points[i2] * a + points[i3] * b + points[i4] * a;
+		}
+		else {
+			if (i == 0) {
+				// first segment
+				p0 = points[0];
+				p1 = points[0]*a + points[1]*b + points[2]*a;
+				p2 = points[1]*a + points[2]*b + points[3]*a;
+			}
+			else if (i == (count - 3)) {
+				// last segment
+				p0 = points[count - 4]*a + points[count - 3]*b + points[count - 2]*a;
+				p1 = points[count - 3]*a + points[count - 2]*b + points[count - 1]*a;
+				p2 = points[count - 1];
+			}
+			else {
+				// middle segment
+				i -= 1;
+				p0 = points[i    ] * a + points[i + 1] * b + points[i + 2] * a;
+				p1 = points[i + 1] * a + points[i + 2] * b + points[i + 3] * a;
+				p2 = points[i + 2] * a + points[i + 3] * b + points[i + 4] * a;
+			}
+		}
+
+		// Same as ez::bezier::interpolate, written out so this function stays constexpr
+		seg[0] = p0 * real_t(0.5) + p1 * real_t(0.5);
+		seg[3] = p1 * real_t(0.5) + p2 * real_t(0.5);
+
+		seg[1] = seg[0] * (real_t(1) - lower) + p1 * lower;
+		seg[2] = p1 * (real_t(1) - upper) + seg[3] * upper;
+
+		return seg;
+	}
+
+	// Calls 'func(index, c0, c1, c2, c3)' for every segment of the path, in order.
+	// Each weighted blend of three points is calculated once and shared by the neighbouring segments,
+	// instead of three times per point as with bpathSegment.
+	template<typename vec_t, typename F>
+	void bpathForEachSegment(const vec_t* points, std::size_t count, bool open, F&& func) {
+		using real_t = ez::vec_value_t<vec_t>;
+
+		constexpr real_t lower(8 / 12.0);
+		constexpr real_t upper = real_t(1) - lower;
+
+		constexpr real_t b = real_t{ 9 } / real_t{ 12 };
+		constexpr real_t a = (1.0 - b) / 2.0;
+
+		const std::size_t numSegments = bpathNumSegments(count, open);
+		if (numSegments == 0) {
+			return;
+		}
+
+		auto wrap = [count](std::size_t j) {
+			return j >= count ? j - count : j;
+		};
+		// The blend centered on point 'j + 1'
+		auto blend = [&](std::size_t j) {
+			return points[wrap(j)] * a + points[wrap(j + 1)] * b + points[wrap(j + 2)] * a;
+		};
+
+		// Sliding window of the blended points, the end of one segment is the start of the next.
+		vec_t p1, p2, start;
+		if (open) {
+			p1 = blend(0);
+			start = points[0] * real_t(0.5) + p1 * real_t(0.5);
+		}
+		else {
+			p1 = blend(1);
+			start = blend(0) * real_t(0.5) + p1 * real_t(0.5);
+		}
+
+		for (std::size_t i = 0; i < numSegments; ++i) {
+			if (open) {
+				p2 = (i + 1 == numSegments) ? points[count - 1] : blend(i + 1);
+			}
+			else {
+				p2 = blend(i + 2);
+			}
+
+			vec_t end = p1 * real_t(0.5) + p2 * real_t(0.5);
+
+			func(i,
+				start,
+				start * (real_t(1) - lower) + p1 * lower,
+				p1 * (real_t(1) - upper) + end * upper,
+				end);
+
+			p1 = p2;
+			start = end;
+		}
+	}
+};
@@ -11,7 +11,7 @@ namespace ez {
 	namespace bezier {
 		// Line interpolation
 		template<typename vec_t>
-		vec_t interpolate(const vec_t& p0, const vec_t& p1, vec_value_t<vec_t> t) {
+		constexpr vec_t interpolate(const vec_t& p0, const vec_t& p1, vec_value_t<vec_t> t) {
 			static_assert(is_vec_v<vec_t>, "ez::bezier::interpolate requires vector types!");
 			using T = vec_value_t<vec_t>;
 			static_assert(std::is_floating_point_v<T>, "ez::bezier::interpolate requires floating point types!");
@@ -21,7 +21,7 @@ namespace ez {
 
 		// Quadratic interpolation
 		template<typename vec_t>
-		vec_t interpolate(const vec_t& p0, const vec_t& p1, const vec_t& p2, vec_value_t<vec_t> t) {
+		constexpr vec_t interpolate(const vec_t& p0, const vec_t& p1, const vec_t& p2, vec_value_t<vec_t> t) {
 			static_assert(is_vec_v<vec_t>, "ez::bezier::interpolate requires vector types!");
 			using T = vec_value_t<vec_t>;
 			static_assert(std::is_floating_point_v<T>, "ez::bezier::interpolate requires floating point types!");
@@ -33,7 +33,7 @@ namespace ez {
 
 		// Cubic interpolation
 		template<typename vec_t>
-		vec_t interpolate(const vec_t& p0, const vec_t& p1, const vec_t& p2, const vec_t& p3, vec_value_t<vec_t> t) {
+		constexpr vec_t interpolate(const vec_t& p0, const vec_t& p1, const vec_t& p2, const vec_t& p3, vec_value_t<vec_t> t) {
 			static_assert(is_vec_v<vec_t>, "ez::bezier::interpolate requires vector types!");
 			using T = vec_value_t<vec_t>;
 			static_assert(std::is_floating_point_v<T>, "ez::bezier::interpolate requires floating point types!");
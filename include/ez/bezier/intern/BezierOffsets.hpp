@@ -1,5 +1,8 @@
 #pragma once
 #include <ez/meta.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include "BezierDerivatives.hpp"
 #include "BezierInterpolation.hpp"
 #include "BezierFitting.hpp"
@@ -9,6 +12,33 @@
 
 namespace ez::bezier {
 	namespace intern {
+		// The number of interior parameters where the offset error is measured, the ends are exact by construction.
+		inline constexpr int OffsetErrorSamples = 5;
+
+		// Smallest parameter range the offset will subdivide to, so curves with cusps still terminate.
+		template<typename T>
+		constexpr T minOffsetRange() noexcept {
+			return T(1) / T(4096);
+		}
+
+		/*
+		Largest error of the offset controls against the exact offset of 'base', sampled at several parameters.
+		The error at each parameter is measured along the normal of the base curve, so the offset drifting along the curve is not counted.
+		*/
+		template<std::size_t N, typename T>
+		T offsetError(const std::array<glm::tvec2<T>, N>& base, const std::array<glm::tvec2<T>, N>& offset, T delta) {
+			T error = T(0);
+			for (int k = 1; k <= OffsetErrorSamples; ++k) {
+				T t = T(k) / T(OffsetErrorSamples + 1);
+				glm::tvec2<T> bp = bezier::interpolateStatic<N>(base.begin(), t);
+				glm::tvec2<T> op = bezier::interpolateStatic<N>(offset.begin(), t);
+				glm::tvec2<T> n = bezier::normalAtStatic<N>(base.begin(), t);
+
+				error = std::max(error, std::abs(glm::dot(op - bp, n) - delta));
+			}
+			return error;
+		}
+
 		// Offset for quadratic or cubic curves
 		// 'simple' means it does no checks for degenerate curves or other exceptional circumstances.
 		template<std::size_t N, typename T, typename output_iter>
@@ -18,25 +48,18 @@ namespace ez::bezier {
 			// The number of points written.
 			std::ptrdiff_t count = 0;
 
-			// To support negative offsets
-			T compare = std::abs(delta);
 			std::array<vec_t, N> base = points, n, offset;
 
 			T range = T(1);
 			T start = T(0);
 
-
-
 			while (start < range) {
 				for (int i = 0; i < N; ++i) {
 					n[i] = bezier::normalAtStatic<N>(base.begin(), T(i) / T(N-1));
 					offset[i] = base[i] + n[i] * delta;
 				}
 
-				vec_t bp = bezier::interpolateStatic<N>(base.begin(), T(0.5));
-				vec_t op = bezier::interpolateStatic<N>(offset.begin(), T(0.5));
-
-				if (std::abs(glm::length(op - bp) - compare) > threshold) {
+				if (range - start > minOffsetRange<T>() && offsetError(base, offset, delta) > threshold) {
 					// Subdivide
 					range = (start + range) * T(0.5);
 					bezier::leftSplitStatic<N>(base.begin(), T(0.5), base.begin());
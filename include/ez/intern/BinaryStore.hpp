@@ -0,0 +1,50 @@
+#pragma once
+#include <cinttypes>
+#include <cstring>
+#include <type_traits>
+
+// Helpers for the binary store layouts of both the bezier and interpolate headers, which are little endian with blocks aligned to 8 bytes.
+
+namespace ez::intern {
+	constexpr std::size_t storeAlign(std::size_t n) noexcept {
+		return (n + 7) & ~std::size_t(7);
+	}
+
+	inline bool hostIsLittleEndian() noexcept {
+		const std::uint16_t value = 1;
+		unsigned char first;
+		std::memcpy(&first, &value, 1);
+		return first == 1;
+	}
+
+	template<typename output_iter>
+	void storeWriteUInt(std::uint64_t value, std::size_t bytes, output_iter& output) {
+		for (std::size_t i = 0; i < bytes; ++i) {
+			*output++ = static_cast<char>((value >> (i * 8)) & 0xFF);
+		}
+	}
+
+	inline std::uint64_t storeReadUInt(const unsigned char* data, std::size_t bytes) noexcept {
+		std::uint64_t value = 0;
+		for (std::size_t i = 0; i < bytes; ++i) {
+			value |= std::uint64_t(data[i]) << (i * 8);
+		}
+		return value;
+	}
+
+	template<typename real_t, typename output_iter>
+	void storeWriteReal(real_t value, output_iter& output) {
+		using uint_t = std::conditional_t<sizeof(real_t) == 4, std::uint32_t, std::uint64_t>;
+		uint_t bits;
+		std::memcpy(&bits, &value, sizeof(real_t));
+		storeWriteUInt(bits, sizeof(real_t), output);
+	}
+
+	// Zero bytes up to the next 8 byte boundary, given the number of bytes written so far
+	template<typename output_iter>
+	void storeWritePadding(std::size_t written, output_iter& output) {
+		for (std::size_t i = written; i < storeAlign(written); ++i) {
+			*output++ = char(0);
+		}
+	}
+};
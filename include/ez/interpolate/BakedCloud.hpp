@@ -0,0 +1,251 @@
+#pragma once
+#include <ez/meta.hpp>
+
+#include <vector>
+#include <cinttypes>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <array>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <ez/interpolate/Execution.hpp>
+
+namespace ez {
+	/*
+	A point cloud (or any other function) sampled onto a regular grid.
+	Lookups are constant time, using multilinear or cubic interpolation of the samples.
+	Inputs outside of the bounds are clamped to the bounds.
+	*/
+	template<typename T, int InDim, int OutDim>
+	class BakedCloud {
+	public:
+		static_assert(InDim > 0 && InDim <= 4, "Input Dimension is out of range!");
+		static_assert(OutDim > 0 && OutDim <= 4, "Output Dimension is out of range!");
+		static_assert(std::is_floating_point_v<T>, "ez::BakedCloud requires floating point types!");
+
+		using real_t = T;
+		using ovec = std::conditional_t<OutDim == 1, T, glm::vec<OutDim, T>>;
+		using ivec = std::conditional_t<InDim == 1, T, glm::vec<InDim, T>>;
+		using Resolution = std::array<std::size_t, InDim>;
+
+		BakedCloud()
+			: lower(0)
+			, upper(0)
+			, resolution{}
+		{}
+
+		// Sample 'source.eval(ivec)' at resolution[i] evenly spaced points along each dimension, the bounds included.
+		template<typename Source, typename Policy>
+		BakedCloud(const Source& source, ivec lo, ivec hi, Resolution res, const Policy& policy)
+			: BakedCloud()
+		{
+			bake(source, lo, hi, res, policy);
+		}
+
+		template<typename Source, typename Policy>
+		void bake(const Source& source, ivec lo, ivec hi, Resolution res, const Policy& policy) {
+			static_assert(ez::is_execution_policy_v<Policy>, "ez::BakedCloud::bake requires an execution policy!");
+
+			lower = lo;
+			upper = hi;
+			resolution = res;
+
+			std::size_t total = 1;
+			for (int d = 0; d < InDim; ++d) {
+				// At least two samples are needed for interpolation
+				assert(resolution[d] >= 2);
+				resolution[d] = std::max(resolution[d], std::size_t(2));
+				total *= resolution[d];
+			}
+			samples.resize(total);
+
+			intern::parallelFor(policy, total, [&](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; ++i) {
+					samples[i] = source.eval(samplePosition(i));
+				}
+			});
+		}
+
+		bool empty() const {
+			return samples.empty();
+		}
+		std::size_t size() const {
+			return samples.size();
+		}
+
+		const Resolution& getResolution() const {
+			return resolution;
+		}
+		const ivec& lowerBound() const {
+			return lower;
+		}
+		const ivec& upperBound() const {
+			return upper;
+		}
+
+		// The sample values, the first dimension varies fastest.
+		const std::vector<ovec>& getSamples() const {
+			return samples;
+		}
+
+		// The input position of the sample at a flat index
+		ivec samplePosition(std::size_t index) const {
+			ivec result(0);
+			for (int d = 0; d < InDim; ++d) {
+				std::size_t cell = index % resolution[d];
+				index /= resolution[d];
+
+				T t = static_cast<T>(cell) / static_cast<T>(resolution[d] - 1);
+				component(result, d) = component(lower, d) + (component(upper, d) - component(lower, d)) * t;
+			}
+			return result;
+		}
+
+		// Multilinear interpolation of the 2^InDim surrounding samples
+		ovec eval(ivec input) const {
+			assert(!empty());
+
+			std::array<std::size_t, InDim> cell;
+			std::array<T, InDim> frac;
+			locate(input, cell, frac);
+
+			ovec result(0);
+			for (int corner = 0; corner < (1 << InDim); ++corner) {
+				std::size_t index = 0, stride = 1;
+				T weight = T(1);
+				for (int d = 0; d < InDim; ++d) {
+					bool high = (corner >> d) & 1;
+					index += (cell[d] + (high ? 1 : 0)) * stride;
+					stride *= resolution[d];
+					weight *= high ? frac[d] : T(1) - frac[d];
+				}
+				result += samples[index] * weight;
+			}
+			return result;
+		}
+
+		// Catmull-Rom interpolation of the 4^InDim surrounding samples, smoother than eval but may overshoot.
+		ovec evalCubic(ivec input) const {
+			assert(!empty());
+
+			std::array<std::size_t, InDim> cell;
+			std::array<T, InDim> frac;
+			locate(input, cell, frac);
+
+			std::array<std::array<T, 4>, InDim> weights;
+			for (int d = 0; d < InDim; ++d) {
+				T t = frac[d], t2 = t * t, t3 = t2 * t;
+				std::array<T, 4>& w = weights[d];
+				w[0] = T(0.5) * (-t3 + T(2) * t2 - t);
+				w[1] = T(0.5) * (T(3) * t3 - T(5) * t2 + T(2));
+				w[2] = T(0.5) * (T(-3) * t3 + T(4) * t2 + t);
+				w[3] = T(0.5) * (t3 - t2);
+
+				// Taps past the edges of the grid are linearly extrapolated, so linear functions are still reproduced exactly.
+				if (cell[d] == 0) {
+					w[1] += T(2) * w[0];
+					w[2] -= w[0];
+					w[0] = T(0);
+				}
+				if (cell[d] + 2 >= resolution[d]) {
+					w[2] += T(2) * w[3];
+					w[1] -= w[3];
+					w[3] = T(0);
+				}
+			}
+
+			ovec result(0);
+			for (int tap = 0; tap < (1 << (2 * InDim)); ++tap) {
+				std::size_t index = 0, stride = 1;
+				T weight = T(1);
+				for (int d = 0; d < InDim; ++d) {
+					int offset = (tap >> (2 * d)) & 3;
+					weight *= weights[d][offset];
+
+					// Zero weight taps may be outside of the grid
+					std::ptrdiff_t i = static_cast<std::ptrdiff_t>(cell[d]) + offset - 1;
+					i = std::clamp(i, std::ptrdiff_t(0), static_cast<std::ptrdiff_t>(resolution[d]) - 1);
+
+					index += static_cast<std::size_t>(i) * stride;
+					stride *= resolution[d];
+				}
+				if (weight != T(0)) {
+					result += samples[index] * weight;
+				}
+			}
+			return result;
+		}
+
+		/*
+		The largest difference between the source and the baked lookup, measured at the center of every cell.
+		The center is where multilinear interpolation is furthest from the samples, so this is a good estimate of the error.
+		*/
+		template<typename Source, typename Policy>
+		T measureError(const Source& source, const Policy& policy) const {
+			static_assert(ez::is_execution_policy_v<Policy>, "ez::BakedCloud::measureError requires an execution policy!");
+
+			std::size_t cells = 1;
+			for (int d = 0; d < InDim; ++d) {
+				cells *= resolution[d] - 1;
+			}
+
+			std::vector<T> errors(cells, T(0));
+			intern::parallelFor(policy, cells, [&](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; ++i) {
+					ivec position(0);
+					std::size_t index = i;
+					for (int d = 0; d < InDim; ++d) {
+						std::size_t cell = index % (resolution[d] - 1);
+						index /= resolution[d] - 1;
+
+						T t = (static_cast<T>(cell) + T(0.5)) / static_cast<T>(resolution[d] - 1);
+						component(position, d) = component(lower, d) + (component(upper, d) - component(lower, d)) * t;
+					}
+
+					ovec diff = source.eval(position) - eval(position);
+					T error = T(0);
+					for (int o = 0; o < OutDim; ++o) {
+						error = std::max(error, std::abs(component(diff, o)));
+					}
+					errors[i] = error;
+				}
+			});
+
+			return errors.empty() ? T(0) : *std::max_element(errors.begin(), errors.end());
+		}
+	private:
+		ivec lower, upper;
+		Resolution resolution;
+		std::vector<ovec> samples;
+
+		// Find the grid cell containing the input, and the position within that cell.
+		void locate(const ivec& input, std::array<std::size_t, InDim>& cell, std::array<T, InDim>& frac) const {
+			for (int d = 0; d < InDim; ++d) {
+				T lo = component(lower, d), hi = component(upper, d);
+				T range = hi - lo;
+
+				T t = range != T(0) ? (component(input, d) - lo) / range : T(0);
+				t = std::clamp(t, T(0), T(1)) * static_cast<T>(resolution[d] - 1);
+
+				std::size_t i = std::min(static_cast<std::size_t>(t), resolution[d] - 2);
+				cell[d] = i;
+				frac[d] = t - static_cast<T>(i);
+			}
+		}
+
+		template<typename V>
+		static decltype(auto) component(V& v, int i) {
+			if constexpr (std::is_floating_point_v<std::decay_t<V>>) {
+				assert(i == 0);
+				return (v);
+			}
+			else {
+				return (v[i]);
+			}
+		}
+	};
+};
@@ -0,0 +1,429 @@
+#pragma once
+#include <ez/meta.hpp>
+#include <cinttypes>
+#include <cstring>
+#include <cassert>
+#include <array>
+#include <vector>
+
+#include <ez/interpolate/PointCloud.hpp>
+#include <ez/interpolate/Execution.hpp>
+#include <ez/interpolate/Weighting.hpp>
+#include <ez/interpolate/intern/SortedPointCloud.hpp>
+#include <ez/interpolate/intern/PointCloudKernel.hpp>
+#include <ez/intern/BinaryStore.hpp>
+
+/*
+Binary layouts for storing the point clouds, designed so that they can be evaluated in place (for example from a memory mapped file).
+Everything is little endian, and each block starts on an 8 byte boundary. Both start with a 32 byte header, see CloudStoreHeader.
+The header of a PointCloud records the id of its weighting kernel, see Weighting.hpp. SortedPointCloud has a fixed kernel, and stores zero.
+
+PointCloud, magic "EZPC", the struct of arrays layout of PackedPointCloud:
+	position  scalar[pointCount] for each input dimension
+	domain    scalar[pointCount] for each input dimension
+	tangent   scalar[pointCount] for each input dimension, for each output dimension
+	output    scalar[pointCount] for each output dimension
+
+SortedPointCloud, magic "EZSC", the row major knot arrays of SortedPointCloud:
+	values    scalar[pointCount * outputs]
+	position  scalar[pointCount * inputs]
+	domain    scalar[pointCount * inputs]
+	tangent   scalar[pointCount * inputs * outputs]
+*/
+
+namespace ez {
+	struct CloudStoreHeader {
+		static constexpr std::array<char, 4> PointCloudMagic{ { 'E', 'Z', 'P', 'C' } };
+		static constexpr std::array<char, 4> SortedMagic{ { 'E', 'Z', 'S', 'C' } };
+		static constexpr std::uint16_t CurrentVersion = 1;
+		static constexpr std::size_t Size = 32;
+
+		std::array<char, 4> magic;
+		std::uint16_t version;
+		// Size in bytes of the scalar type, 4 or 8
+		std::uint8_t scalarSize;
+		// Number of output dimensions
+		std::uint8_t outputs;
+		// Number of input dimensions
+		std::uint64_t inputs;
+		std::uint64_t pointCount;
+		// The id of the weighting kernel
+		std::uint64_t kernel;
+
+		static CloudStoreHeader read(const unsigned char* bytes) {
+			CloudStoreHeader header;
+			std::memcpy(header.magic.data(), bytes, 4);
+			header.version = static_cast<std::uint16_t>(intern::storeReadUInt(bytes + 4, 2));
+			header.scalarSize = bytes[6];
+			header.outputs = bytes[7];
+			header.inputs = intern::storeReadUInt(bytes + 8, 8);
+			header.pointCount = intern::storeReadUInt(bytes + 16, 8);
+			header.kernel = intern::storeReadUInt(bytes + 24, 8);
+			return header;
+		}
+	};
+
+	namespace intern {
+		template<typename output_iter>
+		void writeCloudStoreHeader(const std::array<char, 4>& magic, std::size_t scalarSize, std::size_t outputs, std::size_t inputs, std::size_t pointCount, std::uint32_t kernel, output_iter& output) {
+			for (char c : magic) {
+				*output++ = c;
+			}
+			storeWriteUInt(CloudStoreHeader::CurrentVersion, 2, output);
+			storeWriteUInt(scalarSize, 1, output);
+			storeWriteUInt(outputs, 1, output);
+			storeWriteUInt(inputs, 8, output);
+			storeWriteUInt(pointCount, 8, output);
+			storeWriteUInt(kernel, 8, output);
+		}
+
+		// Size of a block of scalars, padded to 8 bytes
+		template<typename real_t>
+		constexpr std::size_t storeBlockSize(std::size_t count) noexcept {
+			return storeAlign(count * sizeof(real_t));
+		}
+
+		// Check the parts of the header and buffer common to all the views
+		inline bool checkCloudStore(const void* data, std::size_t size, const std::array<char, 4>& magic, std::size_t scalarSize, std::size_t outputs, std::uint32_t kernel, CloudStoreHeader& header) {
+			if (!hostIsLittleEndian()) {
+				return false;
+			}
+			if (data == nullptr || size < CloudStoreHeader::Size || (reinterpret_cast<std::uintptr_t>(data) % 8) != 0) {
+				return false;
+			}
+
+			header = CloudStoreHeader::read(static_cast<const unsigned char*>(data));
+			return header.magic == magic &&
+				header.version == CloudStoreHeader::CurrentVersion &&
+				header.scalarSize == scalarSize &&
+				header.outputs == outputs &&
+				header.kernel == kernel &&
+				header.pointCount < size &&
+				header.inputs < size;
+		}
+	};
+
+	// The number of bytes writeCloudStore will output for the cloud
+	template<typename T, int InDim, int OutDim, typename Kernel>
+	std::size_t cloudStoreSize(const PointCloud<T, InDim, OutDim, Kernel>& cloud) {
+		constexpr std::size_t arrays = 2 * InDim + InDim * OutDim + OutDim;
+		return CloudStoreHeader::Size + arrays * intern::storeBlockSize<T>(cloud.size());
+	}
+
+	// Write the cloud in the store layout, as a sequence of chars. Returns the number of bytes written.
+	template<typename T, int InDim, int OutDim, typename Kernel, typename output_iter>
+	std::size_t writeCloudStore(const PointCloud<T, InDim, OutDim, Kernel>& cloud, output_iter output) {
+		static_assert(sizeof(T) == 4 || sizeof(T) == 8, "ez::writeCloudStore requires float or double clouds!");
+		static_assert(ez::is_output_iterator_v<output_iter>, "ez::writeCloudStore requires an output iterator!");
+		static_assert(ez::is_iterator_writable_v<output_iter, char>, "ez::writeCloudStore requires the output iterator to accept char values!");
+
+		auto component = [](const auto& v, int i) {
+			if constexpr (std::is_floating_point_v<std::decay_t<decltype(v)>>) {
+				return v;
+			}
+			else {
+				return v[i];
+			}
+		};
+
+		const std::size_t count = cloud.size();
+		intern::writeCloudStoreHeader(CloudStoreHeader::PointCloudMagic, sizeof(T), OutDim, InDim, count, weighting::kernel_id_v<Kernel>, output);
+
+		// Write one array, 'get' returns the value for a point
+		auto writeArray = [&](auto&& get) {
+			for (std::size_t i = 0; i < count; ++i) {
+				intern::storeWriteReal(static_cast<T>(get(cloud[i])), output);
+			}
+			intern::storeWritePadding(count * sizeof(T), output);
+		};
+
+		for (int d = 0; d < InDim; ++d) {
+			writeArray([&](const auto& point) { return component(point.position, d); });
+		}
+		for (int d = 0; d < InDim; ++d) {
+			writeArray([&](const auto& point) { return component(point.domain, d); });
+		}
+		for (int d = 0; d < InDim; ++d) {
+			for (int o = 0; o < OutDim; ++o) {
+				writeArray([&](const auto& point) { return component(point.tangent[d], o); });
+			}
+		}
+		for (int o = 0; o < OutDim; ++o) {
+			writeArray([&](const auto& point) { return component(point.output, o); });
+		}
+
+		return cloudStoreSize(cloud);
+	}
+
+	// The number of bytes writeCloudStore will output for the cloud
+	template<typename vec_t>
+	std::size_t cloudStoreSize(const SortedPointCloud<vec_t>& cloud) {
+		using real_t = typename SortedPointCloud<vec_t>::real_t;
+		constexpr std::size_t N = SortedPointCloud<vec_t>::N;
+
+		const std::size_t count = static_cast<std::size_t>(cloud.numPoints());
+		const std::size_t knots = count * static_cast<std::size_t>(cloud.numInputs());
+		return CloudStoreHeader::Size +
+			intern::storeBlockSize<real_t>(count * N) +
+			2 * intern::storeBlockSize<real_t>(knots) +
+			intern::storeBlockSize<real_t>(knots * N);
+	}
+
+	// Write the cloud in the store layout, as a sequence of chars. Returns the number of bytes written.
+	template<typename vec_t, typename output_iter>
+	std::size_t writeCloudStore(const SortedPointCloud<vec_t>& cloud, output_iter output) {
+		using real_t = typename SortedPointCloud<vec_t>::real_t;
+		constexpr std::size_t N = SortedPointCloud<vec_t>::N;
+		static_assert(sizeof(real_t) == 4 || sizeof(real_t) == 8, "ez::writeCloudStore requires float or double clouds!");
+		static_assert(ez::is_output_iterator_v<output_iter>, "ez::writeCloudStore requires an output iterator!");
+		static_assert(ez::is_iterator_writable_v<output_iter, char>, "ez::writeCloudStore requires the output iterator to accept char values!");
+
+		const std::size_t count = static_cast<std::size_t>(cloud.numPoints());
+		const std::size_t knots = count * static_cast<std::size_t>(cloud.numInputs());
+		intern::writeCloudStoreHeader(CloudStoreHeader::SortedMagic, sizeof(real_t), N, static_cast<std::size_t>(cloud.numInputs()), count, 0, output);
+
+		auto writeVectors = [&](const vec_t* data, std::size_t n) {
+			for (std::size_t i = 0; i < n; ++i) {
+				for (std::size_t c = 0; c < N; ++c) {
+					intern::storeWriteReal(data[i][static_cast<int>(c)], output);
+				}
+			}
+			intern::storeWritePadding(n * N * sizeof(real_t), output);
+		};
+		auto writeScalars = [&](const real_t* data, std::size_t n) {
+			for (std::size_t i = 0; i < n; ++i) {
+				intern::storeWriteReal(data[i], output);
+			}
+			intern::storeWritePadding(n * sizeof(real_t), output);
+		};
+
+		writeVectors(cloud.pointData(), count);
+		writeScalars(cloud.knotPositionData(), knots);
+		writeScalars(cloud.knotDomainData(), knots);
+		writeVectors(cloud.knotTangentData(), knots);
+
+		return cloudStoreSize(cloud);
+	}
+
+	/*
+	Read only view of a PointCloud in the store layout, evaluated with the same kernel as PackedPointCloud.
+	Nothing is copied, so the buffer must outlive the view. The buffer must be 8 byte aligned, which memory mapped files always are.
+	*/
+	template<typename T, int InDim, int OutDim, typename Kernel = weighting::InversePower<2>>
+	class PointCloudView {
+	public:
+		static_assert(InDim > 0 && InDim <= 4, "Input Dimension is out of range!");
+		static_assert(OutDim > 0 && OutDim <= 4, "Output Dimension is out of range!");
+
+		using real_t = T;
+		using ovec = std::conditional_t<OutDim == 1, T, glm::vec<OutDim, T>>;
+		using ivec = std::conditional_t<InDim == 1, T, glm::vec<InDim, T>>;
+		using Arrays = intern::PointCloudArrays<T, InDim, OutDim>;
+		using kernel_t = Kernel;
+
+		PointCloudView()
+		{}
+
+		PointCloudView(const void* data, std::size_t size) {
+			assign(data, size);
+		}
+
+		// Point the view at a new buffer. Returns false and leaves the view empty if the buffer is not a valid store for this cloud type and kernel.
+		bool assign(const void* data, std::size_t size) {
+			arrays = Arrays{};
+
+			CloudStoreHeader header;
+			if (!intern::checkCloudStore(data, size, CloudStoreHeader::PointCloudMagic, sizeof(T), OutDim, weighting::kernel_id_v<Kernel>, header) || header.inputs != InDim) {
+				return false;
+			}
+
+			const std::size_t count = static_cast<std::size_t>(header.pointCount);
+			const std::size_t block = intern::storeBlockSize<T>(count);
+			constexpr std::size_t numArrays = 2 * InDim + InDim * OutDim + OutDim;
+			if (CloudStoreHeader::Size + numArrays * block > size) {
+				return false;
+			}
+
+			const unsigned char* ptr = static_cast<const unsigned char*>(data) + CloudStoreHeader::Size;
+			auto next = [&]() {
+				const T* result = reinterpret_cast<const T*>(ptr);
+				ptr += block;
+				return result;
+			};
+
+			for (int d = 0; d < InDim; ++d) {
+				arrays.position[d] = next();
+			}
+			for (int d = 0; d < InDim; ++d) {
+				arrays.domain[d] = next();
+			}
+			for (int d = 0; d < InDim; ++d) {
+				for (int o = 0; o < OutDim; ++o) {
+					arrays.tangent[d][o] = next();
+				}
+			}
+			for (int o = 0; o < OutDim; ++o) {
+				arrays.output[o] = next();
+			}
+			arrays.count = count;
+			return true;
+		}
+
+		std::size_t size() const {
+			return arrays.count;
+		}
+		bool empty() const {
+			return arrays.count == 0;
+		}
+
+		ovec eval(ivec input) const {
+			std::array<T, InDim> in;
+			for (int d = 0; d < InDim; ++d) {
+				in[d] = component(input, d);
+			}
+
+			std::array<T, OutDim> numerator;
+			T sum = intern::accumulatePointCloudArrays<Kernel, T, InDim, OutDim>(arrays, in, numerator);
+
+			ovec result(0);
+			if (sum > T(0)) {
+				for (int o = 0; o < OutDim; ++o) {
+					component(result, o) = numerator[o] / sum;
+				}
+			}
+			return result;
+		}
+
+		// Evaluate 'count' inputs, writing the results to 'output'.
+		template<typename Policy>
+		void evalBatch(const ivec* input, std::size_t count, ovec* output, const Policy& policy) const {
+			static_assert(ez::is_execution_policy_v<Policy>, "ez::PointCloudView::evalBatch requires an execution policy!");
+
+			intern::parallelFor(policy, count, [&](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; ++i) {
+					output[i] = eval(input[i]);
+				}
+			});
+		}
+		void evalBatch(const ivec* input, std::size_t count, ovec* output) const {
+			evalBatch(input, count, output, execution::seq);
+		}
+
+		// The arrays, each one has size() values.
+		const Arrays& getArrays() const {
+			return arrays;
+		}
+	private:
+		Arrays arrays;
+
+		template<typename V>
+		static decltype(auto) component(V& v, int i) {
+			if constexpr (std::is_floating_point_v<std::decay_t<V>>) {
+				assert(i == 0);
+				return (v);
+			}
+			else {
+				return (v[i]);
+			}
+		}
+	};
+
+	/*
+	Read only view of a SortedPointCloud in the store layout, evaluated with the same kernel as SortedPointCloud.
+	Nothing is copied, so the buffer must outlive the view. The buffer must be 8 byte aligned, which memory mapped files always are.
+	*/
+	template<typename vec_t>
+	class SortedPointCloudView {
+	public:
+		using real_t = typename SortedPointCloud<vec_t>::real_t;
+		using index_t = typename SortedPointCloud<vec_t>::index_t;
+		using size_t = std::size_t;
+		static constexpr size_t N = SortedPointCloud<vec_t>::N;
+
+		SortedPointCloudView()
+			: points(0)
+			, inputs(0)
+			, values(nullptr)
+			, knotPositions(nullptr)
+			, knotDomains(nullptr)
+			, knotTangents(nullptr)
+		{}
+
+		SortedPointCloudView(const void* data, std::size_t size)
+			: SortedPointCloudView()
+		{
+			assign(data, size);
+		}
+
+		// Point the view at a new buffer. Returns false and leaves the view empty if the buffer is not a valid store for vec_t.
+		bool assign(const void* data, std::size_t size) {
+			*this = SortedPointCloudView{};
+
+			// The view reinterprets the buffer directly, so the vectors must be tightly packed.
+			CloudStoreHeader header;
+			if (sizeof(vec_t) != sizeof(real_t) * N || !intern::checkCloudStore(data, size, CloudStoreHeader::SortedMagic, sizeof(real_t), N, 0, header)) {
+				return false;
+			}
+
+			const size_t count = static_cast<size_t>(header.pointCount);
+			const size_t m = static_cast<size_t>(header.inputs);
+			if (m != 0 && count > size / m) {
+				return false;
+			}
+			const size_t knots = count * m;
+			const size_t valuesSize = intern::storeBlockSize<real_t>(count * N);
+			const size_t knotSize = intern::storeBlockSize<real_t>(knots);
+			const size_t tangentSize = intern::storeBlockSize<real_t>(knots * N);
+			if (CloudStoreHeader::Size + valuesSize + 2 * knotSize + tangentSize > size) {
+				return false;
+			}
+
+			const unsigned char* ptr = static_cast<const unsigned char*>(data) + CloudStoreHeader::Size;
+			values = reinterpret_cast<const vec_t*>(ptr);
+			ptr += valuesSize;
+			knotPositions = reinterpret_cast<const real_t*>(ptr);
+			ptr += knotSize;
+			knotDomains = reinterpret_cast<const real_t*>(ptr);
+			ptr += knotSize;
+			knotTangents = reinterpret_cast<const vec_t*>(ptr);
+
+			points = count;
+			inputs = m;
+			return true;
+		}
+
+		index_t size() const {
+			return static_cast<index_t>(points);
+		}
+		index_t numPoints() const {
+			return static_cast<index_t>(points);
+		}
+		index_t numInputs() const {
+			return static_cast<index_t>(inputs);
+		}
+
+		// 'input' has numInputs() values
+		vec_t eval(const real_t* input) const {
+			return intern::sortedPointCloudEval(values, knotPositions, knotDomains, knotTangents, points, inputs, input);
+		}
+
+		const vec_t* pointData() const {
+			return values;
+		}
+		const real_t* knotPositionData() const {
+			return knotPositions;
+		}
+		const real_t* knotDomainData() const {
+			return knotDomains;
+		}
+		const vec_t* knotTangentData() const {
+			return knotTangents;
+		}
+	private:
+		size_t points, inputs;
+		const vec_t* values;
+		const real_t* knotPositions;
+		const real_t* knotDomains;
+		const vec_t* knotTangents;
+	};
+};
@@ -0,0 +1,132 @@
+#pragma once
+#include <cinttypes>
+#include <algorithm>
+#include <thread>
+#include <exception>
+#include <vector>
+#include <type_traits>
+
+namespace ez {
+	/*
+	Execution policies for the batch functions of this library.
+	These mirror the standard library policies, but do not require a parallel backend for the standard algorithms.
+	*/
+	namespace execution {
+		struct sequenced_policy {};
+
+		struct parallel_policy {
+			// The number of threads to use, zero uses std::thread::hardware_concurrency()
+			unsigned threads = 0;
+
+			// The smallest number of items worth giving to a single thread.
+			std::size_t grain = 256;
+		};
+
+		inline constexpr sequenced_policy seq{};
+		inline constexpr parallel_policy par{};
+	};
+
+	template<typename T>
+	struct is_execution_policy : std::false_type {};
+	template<>
+	struct is_execution_policy<execution::sequenced_policy> : std::true_type {};
+	template<>
+	struct is_execution_policy<execution::parallel_policy> : std::true_type {};
+
+	template<typename T>
+	inline constexpr bool is_execution_policy_v = is_execution_policy<std::decay_t<T>>::value;
+
+	namespace intern {
+		// The number of blocks parallelForBlocks splits 'count' items into.
+		inline std::size_t parallelBlocks(const execution::sequenced_policy&, std::size_t count) {
+			return count != 0 ? 1 : 0;
+		}
+		inline std::size_t parallelBlocks(const execution::parallel_policy& policy, std::size_t count) {
+			if (count == 0) {
+				return 0;
+			}
+
+			std::size_t threads = policy.threads;
+			if (threads == 0) {
+				threads = std::max(std::thread::hardware_concurrency(), 1u);
+			}
+			std::size_t grain = std::max(policy.grain, std::size_t(1));
+			return std::max(std::min(threads, (count + grain - 1) / grain), std::size_t(1));
+		}
+
+		// Calls 'func(block, begin, end)' over parallelBlocks(policy, count) disjoint ranges that cover [0, count), in order of the block index.
+		// The same policy and count always give the same blocks.
+		template<typename F>
+		void parallelForBlocks(const execution::sequenced_policy&, std::size_t count, F&& func) {
+			if (count != 0) {
+				func(std::size_t(0), std::size_t(0), count);
+			}
+		}
+
+		// Splits [0, count) into contiguous blocks, one per thread. The calling thread runs the last block.
+		template<typename F>
+		void parallelForBlocks(const execution::parallel_policy& policy, std::size_t count, F&& func) {
+			const std::size_t threads = parallelBlocks(policy, count);
+			if (threads == 0) {
+				return;
+			}
+			if (threads == 1) {
+				func(std::size_t(0), std::size_t(0), count);
+				return;
+			}
+
+			std::size_t block = count / threads;
+			std::size_t extra = count % threads;
+
+			// Joins the started workers on every way out, a joinable thread must not be destroyed.
+			struct JoinGuard {
+				std::vector<std::thread> workers;
+
+				void join() {
+					for (std::thread& worker : workers) {
+						if (worker.joinable()) {
+							worker.join();
+						}
+					}
+				}
+				~JoinGuard() {
+					join();
+				}
+			} guard;
+			guard.workers.reserve(threads - 1);
+
+			// Exceptions thrown on the workers, rethrown on the calling thread after the join.
+			std::vector<std::exception_ptr> errors(threads - 1);
+
+			std::size_t begin = 0;
+			for (std::size_t i = 0; i < threads - 1; ++i) {
+				std::size_t end = begin + block + (i < extra ? 1 : 0);
+				guard.workers.emplace_back([&func, &errors, i, begin, end]() {
+					try {
+						func(i, begin, end);
+					}
+					catch (...) {
+						errors[i] = std::current_exception();
+					}
+				});
+				begin = end;
+			}
+			func(threads - 1, begin, count);
+
+			guard.join();
+			for (const std::exception_ptr& error : errors) {
+				if (error) {
+					std::rethrow_exception(error);
+				}
+			}
+		}
+
+		// Calls 'func(begin, end)' over disjoint ranges that cover [0, count).
+		template<typename Policy, typename F>
+		void parallelFor(const Policy& policy, std::size_t count, F&& func) {
+			parallelForBlocks(policy, count, [&func](std::size_t, std::size_t begin, std::size_t end) {
+				func(begin, end);
+			});
+		}
+	};
+};
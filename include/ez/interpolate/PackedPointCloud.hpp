@@ -0,0 +1,182 @@
+#pragma once
+#include <ez/meta.hpp>
+
+#include <vector>
+#include <cinttypes>
+#include <cassert>
+#include <array>
+
+#include <ez/interpolate/PointCloud.hpp>
+#include <ez/interpolate/Execution.hpp>
+#include <ez/interpolate/Weighting.hpp>
+#include <ez/interpolate/intern/PointCloudKernel.hpp>
+
+namespace ez {
+	/*
+	Read only copy of a PointCloud, stored as a struct of arrays.
+	The evaluation only streams the fields it needs, in a kernel the compiler can vectorize.
+	Gives the same results as PointCloud::eval with the same Kernel, use it when a cloud is evaluated far more often than it is edited.
+	*/
+	template<typename T, int InDim, int OutDim, typename Kernel = weighting::InversePower<2>>
+	class PackedPointCloud {
+	public:
+		static_assert(InDim > 0 && InDim <= 4, "Input Dimension is out of range!");
+		static_assert(OutDim > 0 && OutDim <= 4, "Output Dimension is out of range!");
+
+		using real_t = T;
+		using Cloud = PointCloud<T, InDim, OutDim, Kernel>;
+		using kernel_t = Kernel;
+		using ovec = typename Cloud::ovec;
+		using ivec = typename Cloud::ivec;
+		using Arrays = intern::PointCloudArrays<T, InDim, OutDim>;
+
+		// The number of arrays stored per point
+		static constexpr std::size_t ArraysPerPoint = 2 * InDim + InDim * OutDim + OutDim;
+
+		PackedPointCloud()
+		{}
+
+		explicit PackedPointCloud(const Cloud& cloud) {
+			assign(cloud);
+		}
+
+		PackedPointCloud(const PackedPointCloud& other)
+			: data(other.data)
+		{
+			bind(other.arrays.count);
+		}
+		PackedPointCloud(PackedPointCloud&& other) noexcept
+			: data(std::move(other.data))
+		{
+			bind(other.arrays.count);
+			other.arrays = Arrays{};
+		}
+		PackedPointCloud& operator=(const PackedPointCloud& other) {
+			data = other.data;
+			bind(other.arrays.count);
+			return *this;
+		}
+		PackedPointCloud& operator=(PackedPointCloud&& other) noexcept {
+			data = std::move(other.data);
+			bind(other.arrays.count);
+			other.arrays = Arrays{};
+			return *this;
+		}
+
+		void assign(const Cloud& cloud) {
+			const std::size_t count = cloud.size();
+			data.assign(count * ArraysPerPoint, T(0));
+			bind(count);
+
+			for (std::size_t i = 0; i < count; ++i) {
+				const auto& point = cloud[i];
+				for (int d = 0; d < InDim; ++d) {
+					mutableArray(arrays.position[d])[i] = component(point.position, d);
+					mutableArray(arrays.domain[d])[i] = component(point.domain, d);
+					for (int o = 0; o < OutDim; ++o) {
+						mutableArray(arrays.tangent[d][o])[i] = component(point.tangent[d], o);
+					}
+				}
+				for (int o = 0; o < OutDim; ++o) {
+					mutableArray(arrays.output[o])[i] = component(point.output, o);
+				}
+			}
+		}
+
+		std::size_t size() const {
+			return arrays.count;
+		}
+		bool empty() const {
+			return arrays.count == 0;
+		}
+
+		static constexpr int inputDimensions() {
+			return InDim;
+		}
+		static constexpr int outputDimensions() {
+			return OutDim;
+		}
+
+		ovec eval(ivec input) const {
+			std::array<T, InDim> in;
+			for (int d = 0; d < InDim; ++d) {
+				in[d] = component(input, d);
+			}
+
+			std::array<T, OutDim> numerator;
+			T sum = intern::accumulatePointCloudArrays<Kernel, T, InDim, OutDim>(arrays, in, numerator);
+
+			ovec result(0);
+			if (sum > T(0)) {
+				for (int o = 0; o < OutDim; ++o) {
+					component(result, o) = numerator[o] / sum;
+				}
+			}
+			return result;
+		}
+
+		// Evaluate 'count' inputs, writing the results to 'output'.
+		template<typename Policy>
+		void evalBatch(const ivec* input, std::size_t count, ovec* output, const Policy& policy) const {
+			static_assert(ez::is_execution_policy_v<Policy>, "ez::PackedPointCloud::evalBatch requires an execution policy!");
+
+			intern::parallelFor(policy, count, [&](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; ++i) {
+					output[i] = eval(input[i]);
+				}
+			});
+		}
+		void evalBatch(const ivec* input, std::size_t count, ovec* output) const {
+			evalBatch(input, count, output, execution::seq);
+		}
+
+		// The arrays, each one has size() values.
+		const Arrays& getArrays() const {
+			return arrays;
+		}
+	private:
+		// All the arrays back to back, in the order position, domain, tangent, output.
+		std::vector<T> data;
+		Arrays arrays;
+
+		T* mutableArray(const T* ptr) {
+			return data.data() + (ptr - data.data());
+		}
+
+		// Point the arrays into the data buffer
+		void bind(std::size_t count) {
+			arrays.count = count;
+
+			const T* ptr = data.data();
+			for (int d = 0; d < InDim; ++d) {
+				arrays.position[d] = ptr;
+				ptr += count;
+			}
+			for (int d = 0; d < InDim; ++d) {
+				arrays.domain[d] = ptr;
+				ptr += count;
+			}
+			for (int d = 0; d < InDim; ++d) {
+				for (int o = 0; o < OutDim; ++o) {
+					arrays.tangent[d][o] = ptr;
+					ptr += count;
+				}
+			}
+			for (int o = 0; o < OutDim; ++o) {
+				arrays.output[o] = ptr;
+				ptr += count;
+			}
+		}
+
+		template<typename V>
+		static decltype(auto) component(V& v, int i) {
+			if constexpr (std::is_floating_point_v<std::decay_t<V>>) {
+				assert(i == 0);
+				return (v);
+			}
+			else {
+				return (v[i]);
+			}
+		}
+	};
+};
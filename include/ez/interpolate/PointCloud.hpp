@@ -8,29 +8,43 @@
 #include <cmath>
 #include <algorithm>
 #include <array>
+#include <limits>
 
 #include <glm/geometric.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
+#include <ez/interpolate/Execution.hpp>
+#include <ez/interpolate/Weighting.hpp>
+#include <ez/interpolate/BakedCloud.hpp>
+#include <ez/interpolate/intern/PointCloudTree.hpp>
+
 namespace ez {
 
 	/*
 	Interpolation using a cloud of points.
 	There can be as many input dimensions as needed.
 	Manipulating point clouds locally is easier than manipulating bezier curves, its just the transistions to new region on the cloud that is more difficult
-	Derivatives can be calculated easily using automatic differentiation.
+	Derivatives with respect to the input are calculated analytically by evalWithGradient, and with respect to the points by evalAdjoint.
+
+	For large clouds call buildIndex() after editing the points, evalNearest and evalRadius will then only visit the points near the input,
+	and evalApprox will blend distant groups of points as single points.
+
+	The weight of each point is set by the Kernel, see Weighting.hpp. The default is inverse squared distance.
+	Kernels with a finite cutoff skip the points outside of it, using the index if it is up to date.
 	*/
-	template<typename T, int InDim, int OutDim>
+	template<typename T, int InDim, int OutDim, typename Kernel = weighting::InversePower<2>>
 	class PointCloud {
 	public:
 		static_assert(InDim > 0 && InDim <= 4, "Input Dimension is out of range!");
 		static_assert(OutDim > 0 && OutDim <= 4, "Output Dimension is out of range!");
+		static_assert(weighting::has_constexpr_cutoff_v<Kernel, T>, "ez::PointCloud requires the Kernel to have a static constexpr cutoff<T>() function!");
 
 		using real_t = T;
 		using ovec = std::conditional_t<OutDim == 1, T, glm::vec<OutDim, T>>;
 		using ivec = std::conditional_t<InDim == 1, T, glm::vec<InDim, T>>;
+		using kernel_t = Kernel;
 
 		struct Dimension;
 		using index_t = std::intptr_t;
@@ -61,11 +75,17 @@ namespace ez {
 
 			// The output point at this input position.
 			ovec output;
-		private:
-			mutable real_t cache;
-			friend class PointCloud;
 		};
 
+		// Output of evalWithGradient, jacobian[i] is the derivative of the output along input dimension i.
+		struct Gradient {
+			ovec value;
+			std::array<ovec, InDim> jacobian;
+		};
+
+		// Upper limit on the number of neighbours evalNearest and evalWeights can blend.
+		static constexpr std::size_t MaxNeighbors = 64;
+
 		using container_t = std::vector<Point>;
 		using iterator = typename container_t::iterator;
 		using const_iterator = typename container_t::const_iterator;
@@ -76,10 +96,12 @@ namespace ez {
 		PointCloud& operator=(PointCloud&&) noexcept = default;
 		
 		PointCloud()
+			: indexDirty(true)
 		{}
 
 		PointCloud(std::size_t cap)
 			: points{cap}
+			, indexDirty(true)
 		{}
 
 		static constexpr int inputDimensions() {
@@ -91,25 +113,32 @@ namespace ez {
 
 		void push_back(ivec input, ovec output) {
 			points.push_back(Point(input, output));
+			indexDirty = true;
 		}
 		void append(ivec input, ovec output) {
 			points.push_back(Point(input, output));
+			indexDirty = true;
 		}
 		void pop_back() {
 			points.pop_back();
+			indexDirty = true;
 		}
 		void erase(const_iterator iter) {
 			points.erase(iter);
+			indexDirty = true;
 		}
 		void insert(iterator iter, const Point & value) {
 			points.insert(iter, value);
+			indexDirty = true;
 		}
 		void resize(std::size_t count) {
 			points.resize(count);
+			indexDirty = true;
 		}
 
 		Point& operator[](std::size_t index) {
 			assert(index < size());
+			indexDirty = true;
 			return points[index];
 		}
 		const Point& operator[](std::size_t index) const {
@@ -126,12 +155,15 @@ namespace ez {
 
 		void clear() {
 			points.clear();
+			indexDirty = true;
 		}
 
 		iterator begin() {
+			indexDirty = true;
 			return points.begin();
 		}
 		iterator end() {
+			indexDirty = true;
 			return points.end();
 		}
 
@@ -142,57 +174,594 @@ namespace ez {
 			return points.end();
 		}
 
+		// Evaluation does not modify the cloud, so a const cloud can be evaluated from multiple threads at once.
 		ovec eval(ivec input) const {
-			ovec result(0);
+			real_t sum;
+			return evalWithSum(input, sum);
+		}
+
+		/*
+		Evaluate the output along with its derivatives, in the same pass over the points as eval.
+		With f = N / S, where N = sum(w * v) and S = sum(w), the derivative along each input is (N' - f * S') / S.
+		*/
+		Gradient evalWithGradient(ivec input) const {
+			Gradient result;
+			result.value = ovec(0);
+			result.jacobian.fill(ovec(0));
+
 			real_t sum = real_t(0);
+			std::array<real_t, InDim> sumDerivative{};
 
-			// We calculate the coefficient, add it to the sum, then cache the coefficient for the second pass
 			for (const Point& point : points) {
-				ivec delta = input - point.position;
+				real_t dist2 = distance2(point, input);
+				real_t coeff = weight(dist2);
+				real_t dcoeff = Kernel::derivative(dist2);
+				ovec val = value(point, input);
 
-				delta = point.domain * delta * delta;
+				sum += coeff;
+				result.value += val * coeff;
 
-				real_t coeff = 0.f;
-				if constexpr (InDim == 1) {
-					coeff = delta;
+				// d/dx of weight(domain * delta^2) is weight' * 2 * domain * delta
+				auto delta = toArray(input - point.position);
+				auto domain = toArray(point.domain);
+				for (int i = 0; i < InDim; ++i) {
+					real_t dw = real_t(2) * dcoeff * domain[i] * delta[i];
+					sumDerivative[i] += dw;
+					result.jacobian[i] += val * dw + point.tangent[i] * coeff;
 				}
-				else {
-					for (int i = 0; i < InDim; ++i) {
-						coeff += delta[i];
+			}
+
+			if (sum > real_t(0)) {
+				result.value /= sum;
+				for (int i = 0; i < InDim; ++i) {
+					result.jacobian[i] = (result.jacobian[i] - result.value * sumDerivative[i]) / sum;
+				}
+			}
+			return result;
+		}
+
+		// Evaluate 'count' inputs, writing the results to 'output'.
+		template<typename Policy>
+		void evalBatch(const ivec* input, std::size_t count, ovec* output, const Policy& policy) const {
+			static_assert(ez::is_execution_policy_v<Policy>, "ez::PointCloud::evalBatch requires an execution policy!");
+
+			intern::parallelFor(policy, count, [&](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; ++i) {
+					output[i] = eval(input[i]);
+				}
+			});
+		}
+		void evalBatch(const ivec* input, std::size_t count, ovec* output) const {
+			evalBatch(input, count, output, execution::seq);
+		}
+
+		/*
+		Reverse mode derivatives of eval with respect to the parameters of every point, for fitting the cloud to data.
+		outputGradients[s] is the derivative of the loss with respect to eval(inputs[s]).
+		gradients[j] is set to the derivative of the loss summed over the batch, with respect to each field of point j.
+
+		The inputs are evaluated first, then the gradients are accumulated in a single pass over the points,
+		so each point is only written by one thread and the batch can be split across threads without locking.
+		*/
+		template<typename Policy>
+		void evalAdjoint(const ivec* inputs, const ovec* outputGradients, std::size_t count, Point* gradients, const Policy& policy) const {
+			static_assert(ez::is_execution_policy_v<Policy>, "ez::PointCloud::evalAdjoint requires an execution policy!");
+
+			std::vector<ovec> values(count);
+			std::vector<real_t> sums(count);
+			intern::parallelFor(policy, count, [&](std::size_t first, std::size_t last) {
+				for (std::size_t s = first; s < last; ++s) {
+					values[s] = evalWithSum(inputs[s], sums[s]);
+				}
+			});
+
+			constexpr real_t cutoff = Kernel::template cutoff<real_t>();
+			intern::parallelFor(policy, points.size(), [&](std::size_t first, std::size_t last) {
+				for (std::size_t j = first; j < last; ++j) {
+					const Point& point = points[j];
+					Point& gradient = gradients[j];
+
+					gradient.position = ivec(0);
+					gradient.domain = ivec(0);
+					gradient.tangent.fill(ovec(0));
+					gradient.output = ovec(0);
+
+					for (std::size_t s = 0; s < count; ++s) {
+						real_t dist2 = distance2(point, inputs[s]);
+						if (!(sums[s] > real_t(0)) || !(dist2 < cutoff)) {
+							continue;
+						}
+
+						// With f = N / S, df/dw = (v - f) / S and df/dv = w / S
+						const real_t invSum = real_t(1) / sums[s];
+						const real_t coeff = weight(dist2);
+						const ovec& upstream = outputGradients[s];
+						const ovec weighted = upstream * (coeff * invSum);
+						const real_t dweight = dotOf(upstream, value(point, inputs[s]) - values[s]) * invSum;
+						const real_t ddist = dweight * Kernel::derivative(dist2);
+
+						const ivec delta = inputs[s] - point.position;
+						auto deltas = toArray(delta);
+
+						gradient.output += weighted;
+						gradient.domain += delta * delta * ddist;
+
+						// The position moves both the distance and the tangent offset
+						auto position = toArray(point.domain * delta * (real_t(-2) * ddist));
+						for (int i = 0; i < InDim; ++i) {
+							gradient.tangent[i] += weighted * deltas[i];
+							position[i] -= dotOf(weighted, point.tangent[i]);
+						}
+						gradient.position += fromArray(position);
 					}
 				}
+			});
+		}
+		void evalAdjoint(const ivec* inputs, const ovec* outputGradients, std::size_t count, Point* gradients) const {
+			evalAdjoint(inputs, outputGradients, count, gradients, execution::seq);
+		}
 
-				// We add an epsilion value to prevent division by zero
-				coeff = real_t(1) / (ez::epsilon<real_t>() + coeff);
+		/*
+		Sample the cloud onto a regular grid spanning [lower, upper], with resolution[i] samples along input dimension i.
+		The result answers queries in constant time, check BakedCloud::measureError to pick a resolution.
+		Without a policy the samples are computed with execution::par, a grid smaller than its grain stays on the calling thread.
+		*/
+		template<typename Policy>
+		BakedCloud<T, InDim, OutDim> bake(ivec lower, ivec upper, const std::array<std::size_t, InDim>& resolution, const Policy& policy) const {
+			return BakedCloud<T, InDim, OutDim>{ *this, lower, upper, resolution, policy };
+		}
+		BakedCloud<T, InDim, OutDim> bake(ivec lower, ivec upper, const std::array<std::size_t, InDim>& resolution) const {
+			return bake(lower, upper, resolution, execution::par);
+		}
 
-				sum += coeff;
-				point.cache = coeff;
+		// Build the spatial index used by evalNearest and evalRadius.
+		// Any non-const access to the points invalidates the index, so call this again after editing the cloud.
+		void buildIndex() {
+			std::vector<typename Tree::position_t> positions(points.size());
+			std::vector<T> minDomains(points.size());
+			for (std::size_t i = 0; i < points.size(); ++i) {
+				positions[i] = toArray(points[i].position);
+
+				auto domain = toArray(points[i].domain);
+				minDomains[i] = *std::min_element(domain.begin(), domain.end());
 			}
 
-			// normalize the influence factors, sum result vector
-			for (const Point& point : points) {
-				ivec delta = input - point.position;
+			tree.build(positions, minDomains);
+			buildClusters();
+			indexDirty = false;
+		}
+
+		// Is there an up to date spatial index?
+		bool hasIndex() const {
+			return !indexDirty;
+		}
 
-				// normalization, note that if sum == inf, then most likely at least one point.cache == inf.
-				// So the factor will == 1 for at least one point.
-				real_t factor = point.cache / sum;
+		/*
+		Blend only the k points closest to the input (by the domain scaled distance).
+		The weight of the next closest point is subtracted from the k weights before normalizing, so the result stays continuous when the set of neighbours changes.
+		k must be at most MaxNeighbors, unless k >= size(), where this falls back to eval.
+		Uses the spatial index if it is up to date, otherwise all the points are checked.
+		*/
+		ovec evalNearest(ivec input, std::size_t k) const {
+			if (k >= points.size()) {
+				return eval(input);
+			}
+
+			std::array<Neighbor, MaxNeighbors + 1> nearest;
+			std::array<real_t, MaxNeighbors> weights;
+			std::size_t count = nearestWeights(input, k, nearest.data(), weights.data());
+
+			ovec result(0);
+			for (std::size_t i = 0; i < count; ++i) {
+				result += value(points[nearest[i].index], input) * weights[i];
+			}
+			return result;
+		}
+
+		/*
+		The normalized weights evalNearest would blend with, instead of the blended output.
+		Writes up to 'maxCount' point indices and their weights, nearest first, and returns the number written.
+		'maxCount' must be at most MaxNeighbors.
+		The weights sum to one, so the outputs (or anything else associated with the points) can be blended directly.
+		Returns zero when the kernel gives every neighbour a weight of zero, like an input outside the support of a compact kernel.
+		Note that the tangents are not included, use evalNearest for the full result.
+		*/
+		std::size_t evalWeights(ivec input, std::size_t maxCount, std::size_t* outIndices, real_t* outWeights) const {
+			std::array<Neighbor, MaxNeighbors + 1> nearest;
+			std::size_t count = nearestWeights(input, maxCount, nearest.data(), outWeights);
+
+			for (std::size_t i = 0; i < count; ++i) {
+				outIndices[i] = nearest[i].index;
+			}
+			return count;
+		}
+
+		/*
+		Blend only the points within the radius of the input (by the domain scaled distance).
+		The weight at the radius is subtracted from each weight before normalizing, so points fade out smoothly as they leave the radius.
+		Returns zero if there are no points within the radius.
+		Uses the spatial index if it is up to date, otherwise all the points are checked.
+		*/
+		ovec evalRadius(ivec input, real_t radius) const {
+			const real_t cutoff = radius * radius;
+			const real_t offset = weight(cutoff);
 
-				ovec offset{0.f};
-				if constexpr (InDim == 1) {
-					offset = point.tangent[0] * delta;
+			ovec result(0);
+			real_t sum = real_t(0);
+
+			auto visit = [&](std::size_t index) {
+				const Point& point = points[index];
+				real_t dist2 = distance2(point, input);
+				if (dist2 < cutoff) {
+					real_t coeff = weight(dist2) - offset;
+					sum += coeff;
+					result += value(point, input) * coeff;
 				}
-				else {
+			};
+
+			if (hasIndex()) {
+				tree.search(toArray(input), [cutoff]() { return cutoff; }, visit);
+			}
+			else {
+				for (std::size_t i = 0; i < points.size(); ++i) {
+					visit(i);
+				}
+			}
+
+			if (sum > real_t(0)) {
+				result /= sum;
+			}
+			return result;
+		}
+
+		/*
+		Barnes-Hut style approximation of eval.
+		Nodes of the index that are far enough away are blended as a single pseudo point, placed at the centroid of the node
+		with the mean domain, and with the summed outputs and tangents of the points it contains.
+		A node is treated as a single point when its size is less than 'theta' times the distance to its centroid,
+		so zero is exact and larger values are faster but less accurate. Around 0.5 is a reasonable starting point.
+		Requires an up to date index, otherwise this is the same as eval.
+		*/
+		ovec evalApprox(ivec input, real_t theta) const {
+			if (!hasIndex() || points.empty()) {
+				return eval(input);
+			}
+
+			const auto& nodes = tree.getNodes();
+			const auto& order = tree.getOrder();
+			const auto query = toArray(input);
+			const real_t theta2 = theta * theta;
+
+			ovec result(0);
+			real_t sum = real_t(0);
+
+			std::array<std::int32_t, 64> stack;
+			std::size_t top = 0;
+			stack[top++] = 0;
+
+			while (top != 0) {
+				const auto& node = nodes[stack[--top]];
+
+				if (node.left < 0) {
+					for (std::uint32_t i = node.begin; i < node.end; ++i) {
+						const Point& point = points[order[i]];
+						real_t coeff = weight(distance2(point, input));
+						sum += coeff;
+						result += value(point, input) * coeff;
+					}
+					continue;
+				}
+
+				const Cluster& cluster = clusters[&node - nodes.data()];
+				real_t size2 = real_t(0), dist2 = real_t(0);
+				auto centroid = toArray(cluster.centroid);
+				for (int i = 0; i < InDim; ++i) {
+					real_t extent = node.hi[i] - node.lo[i];
+					real_t offset = query[i] - centroid[i];
+					size2 += extent * extent;
+					dist2 += offset * offset;
+				}
+
+				if (size2 < theta2 * dist2) {
+					// The sum of the point values at the input, divided by the count
+					ovec val = cluster.sumOutput - cluster.sumTangentPosition;
 					for (int i = 0; i < InDim; ++i) {
-						offset += point.tangent[i] * delta[i];
+						val += cluster.sumTangent[i] * query[i];
 					}
+					val /= cluster.count;
+
+					ivec delta = input - cluster.centroid;
+					ivec scaled = cluster.meanDomain * delta * delta;
+					real_t coeff = cluster.count * weight(sumOf(scaled));
+
+					sum += coeff;
+					result += val * coeff;
 				}
+				else {
+					assert(top + 2 <= stack.size());
+					stack[top++] = node.left;
+					stack[top++] = node.right;
+				}
+			}
 
-				result += (point.output + offset) * factor;
+			if (sum > real_t(0)) {
+				result /= sum;
 			}
 			return result;
 		}
 
 	private:
+		using Tree = intern::PointCloudTree<T, InDim>;
+
+		struct Neighbor {
+			real_t distance2;
+			std::size_t index;
+		};
+
 		std::vector<Point> points;
+
+		Tree tree;
+
+		// Aggregate of the points below a tree node, used by evalApprox to stand in for the whole node.
+		struct Cluster {
+			real_t count;
+			ivec centroid;
+			ivec meanDomain;
+			ovec sumOutput;
+			std::array<ovec, InDim> sumTangent;
+			// Sum of tangent[i] * position[i] over all the points and dimensions
+			ovec sumTangentPosition;
+		};
+		// Indexed the same as the tree nodes
+		std::vector<Cluster> clusters;
+		bool indexDirty;
+
+		static std::array<T, InDim> toArray(const ivec& v) {
+			std::array<T, InDim> result;
+			if constexpr (InDim == 1) {
+				result[0] = v;
+			}
+			else {
+				for (int i = 0; i < InDim; ++i) {
+					result[i] = v[i];
+				}
+			}
+			return result;
+		}
+
+		static ivec fromArray(const std::array<T, InDim>& v) {
+			if constexpr (InDim == 1) {
+				return v[0];
+			}
+			else {
+				ivec result;
+				for (int i = 0; i < InDim; ++i) {
+					result[i] = v[i];
+				}
+				return result;
+			}
+		}
+
+		static real_t dotOf(const ovec& lh, const ovec& rh) {
+			if constexpr (OutDim == 1) {
+				return lh * rh;
+			}
+			else {
+				return glm::dot(lh, rh);
+			}
+		}
+
+		static real_t sumOf(const ivec& v) {
+			if constexpr (InDim == 1) {
+				return v;
+			}
+			else {
+				real_t total = real_t(0);
+				for (int i = 0; i < InDim; ++i) {
+					total += v[i];
+				}
+				return total;
+			}
+		}
+
+		// eval, also writing out the sum of the weights.
+		ovec evalWithSum(const ivec& input, real_t& sum) const {
+			ovec result(0);
+			sum = real_t(0);
+
+			// Single pass, the weighted outputs are summed along with the weights and normalized at the end.
+			auto visit = [&](const Point& point, real_t dist2) {
+				real_t coeff = weight(dist2);
+
+				sum += coeff;
+				result += value(point, input) * coeff;
+			};
+
+			constexpr real_t cutoff = Kernel::template cutoff<real_t>();
+			if constexpr (cutoff < std::numeric_limits<real_t>::infinity()) {
+				if (hasIndex()) {
+					tree.search(toArray(input), [cutoff]() { return cutoff; }, [&](std::size_t index) {
+						real_t dist2 = distance2(points[index], input);
+						if (dist2 < cutoff) {
+							visit(points[index], dist2);
+						}
+					});
+				}
+				else {
+					for (const Point& point : points) {
+						real_t dist2 = distance2(point, input);
+						if (dist2 < cutoff) {
+							visit(point, dist2);
+						}
+					}
+				}
+			}
+			else {
+				for (const Point& point : points) {
+					visit(point, distance2(point, input));
+				}
+			}
+
+			if (sum > real_t(0)) {
+				result /= sum;
+			}
+			return result;
+		}
+
+		// The domain scaled squared distance from the point to the input
+		static real_t distance2(const Point& point, const ivec& input) {
+			ivec delta = input - point.position;
+			return sumOf(point.domain * delta * delta);
+		}
+
+		// Compute the aggregates of every node, children always come after their parent so walk the nodes in reverse.
+		void buildClusters() {
+			const auto& nodes = tree.getNodes();
+			const auto& order = tree.getOrder();
+			clusters.resize(nodes.size());
+
+			for (std::size_t n = nodes.size(); n-- > 0;) {
+				const auto& node = nodes[n];
+				Cluster& cluster = clusters[n];
+
+				if (node.left < 0) {
+					cluster.count = real_t(0);
+					cluster.centroid = ivec(0);
+					cluster.meanDomain = ivec(0);
+					cluster.sumOutput = ovec(0);
+					cluster.sumTangent.fill(ovec(0));
+					cluster.sumTangentPosition = ovec(0);
+
+					for (std::uint32_t i = node.begin; i < node.end; ++i) {
+						const Point& point = points[order[i]];
+						auto position = toArray(point.position);
+
+						cluster.count += real_t(1);
+						cluster.centroid += point.position;
+						cluster.meanDomain += point.domain;
+						cluster.sumOutput += point.output;
+						for (int d = 0; d < InDim; ++d) {
+							cluster.sumTangent[d] += point.tangent[d];
+							cluster.sumTangentPosition += point.tangent[d] * position[d];
+						}
+					}
+				}
+				else {
+					// Children still hold sums at this point, they are only divided once the parent is done with them.
+					const Cluster& lh = clusters[node.left];
+					const Cluster& rh = clusters[node.right];
+
+					cluster.count = lh.count + rh.count;
+					cluster.centroid = lh.centroid + rh.centroid;
+					cluster.meanDomain = lh.meanDomain + rh.meanDomain;
+					cluster.sumOutput = lh.sumOutput + rh.sumOutput;
+					for (int d = 0; d < InDim; ++d) {
+						cluster.sumTangent[d] = lh.sumTangent[d] + rh.sumTangent[d];
+					}
+					cluster.sumTangentPosition = lh.sumTangentPosition + rh.sumTangentPosition;
+				}
+			}
+
+			for (Cluster& cluster : clusters) {
+				cluster.centroid /= cluster.count;
+				cluster.meanDomain /= cluster.count;
+			}
+		}
+
+		static real_t weight(real_t dist2) {
+			return Kernel::weight(dist2);
+		}
+
+		// The output of the point, offset by its tangents
+		static ovec value(const Point& point, const ivec& input) {
+			ivec delta = input - point.position;
+
+			ovec offset{ 0.f };
+			if constexpr (InDim == 1) {
+				offset = point.tangent[0] * delta;
+			}
+			else {
+				for (int i = 0; i < InDim; ++i) {
+					offset += point.tangent[i] * delta[i];
+				}
+			}
+			return point.output + offset;
+		}
+
+		// Find up to 'k' nearest points, sorted by distance. Returns the number found.
+		std::size_t findNearest(const ivec& input, std::size_t k, Neighbor* out) const {
+			std::size_t count = 0;
+			auto farther = [](const Neighbor& lh, const Neighbor& rh) {
+				return lh.distance2 < rh.distance2;
+			};
+
+			// Max heap on distance, so the farthest of the current neighbours is at the front.
+			auto visit = [&](std::size_t index) {
+				real_t dist2 = distance2(points[index], input);
+				if (count < k) {
+					out[count++] = Neighbor{ dist2, index };
+					std::push_heap(out, out + count, farther);
+				}
+				else if (dist2 < out[0].distance2) {
+					std::pop_heap(out, out + count, farther);
+					out[count - 1] = Neighbor{ dist2, index };
+					std::push_heap(out, out + count, farther);
+				}
+			};
+
+			if (hasIndex()) {
+				auto cutoff = [&]() {
+					return count < k ? std::numeric_limits<real_t>::infinity() : out[0].distance2;
+				};
+				tree.search(toArray(input), cutoff, visit);
+			}
+			else {
+				for (std::size_t i = 0; i < points.size(); ++i) {
+					visit(i);
+				}
+			}
+
+			std::sort_heap(out, out + count, farther);
+			return count;
+		}
+
+		// Find the k nearest points and their normalized weights, with the weight of the next nearest point subtracted from each.
+		// 'nearest' needs room for k+1 neighbours. Returns the number of neighbours found, at most k, or zero if every weight is zero.
+		std::size_t nearestWeights(const ivec& input, std::size_t k, Neighbor* nearest, real_t* weights) const {
+			assert(k > 0 && k <= MaxNeighbors);
+			k = std::min(k, MaxNeighbors);
+
+			// Find k+1 neighbours, the last only provides the weight offset.
+			std::size_t count = findNearest(input, k + 1, nearest);
+
+			real_t offset = real_t(0);
+			if (count > k) {
+				offset = weight(nearest[k].distance2);
+				count = k;
+			}
+
+			real_t sum = real_t(0);
+			for (std::size_t i = 0; i < count; ++i) {
+				weights[i] = weight(nearest[i].distance2) - offset;
+				sum += weights[i];
+			}
+
+			if (sum > real_t(0)) {
+				for (std::size_t i = 0; i < count; ++i) {
+					weights[i] /= sum;
+				}
+			}
+			else if (offset > real_t(0)) {
+				// All the neighbours are tied with the next point, fall back to an even blend.
+				for (std::size_t i = 0; i < count; ++i) {
+					weights[i] = real_t(1) / static_cast<real_t>(count);
+				}
+			}
+			else {
+				// Outside the support of every neighbour, like eval there is nothing to blend.
+				return 0;
+			}
+			return count;
+		}
 	};
 };
\ No newline at end of file
@@ -0,0 +1,229 @@
+#pragma once
+#include <ez/meta.hpp>
+
+#include <vector>
+#include <cinttypes>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include <ez/interpolate/PointCloud.hpp>
+#include <ez/interpolate/Execution.hpp>
+#include <ez/interpolate/Weighting.hpp>
+#include <ez/interpolate/intern/PointCloudKernel.hpp>
+
+namespace ez {
+	/*
+	Read only copy of a PointCloud, like PackedPointCloud but with the positions, domains and tangents stored as normalized 16 bit integers.
+	Each array is quantized over its own range of values, so the error of each value is at most half of (max - min) / 65535 for that array.
+	The outputs are kept at full precision. The values are dequantized in the evaluation kernel.
+
+	Use this for clouds too large for the cache, where the evaluation is limited by memory bandwidth. Smaller clouds are faster as a PackedPointCloud.
+	The gain needs a build targeting AVX2 or later, with only SSE2 the dequantization costs more than the bandwidth saves. See tests/bench/quantized.cpp.
+	*/
+	template<typename T, int InDim, int OutDim, typename Kernel = weighting::InversePower<2>>
+	class QuantizedPointCloud {
+	public:
+		static_assert(InDim > 0 && InDim <= 4, "Input Dimension is out of range!");
+		static_assert(OutDim > 0 && OutDim <= 4, "Output Dimension is out of range!");
+
+		using real_t = T;
+		using storage_t = std::uint16_t;
+		using Cloud = PointCloud<T, InDim, OutDim, Kernel>;
+		using ovec = typename Cloud::ovec;
+		using ivec = typename Cloud::ivec;
+		using Arrays = intern::QuantizedPointCloudArrays<T, storage_t, InDim, OutDim>;
+		using Range = intern::QuantizedRange<T>;
+		using kernel_t = Kernel;
+
+		// The number of quantized arrays stored per point
+		static constexpr std::size_t ArraysPerPoint = 2 * InDim + InDim * OutDim;
+
+		QuantizedPointCloud()
+		{}
+
+		explicit QuantizedPointCloud(const Cloud& cloud) {
+			assign(cloud);
+		}
+
+		QuantizedPointCloud(const QuantizedPointCloud& other)
+			: quantized(other.quantized)
+			, outputs(other.outputs)
+			, arrays(other.arrays)
+		{
+			bind(other.arrays.count);
+		}
+		QuantizedPointCloud(QuantizedPointCloud&& other) noexcept
+			: quantized(std::move(other.quantized))
+			, outputs(std::move(other.outputs))
+			, arrays(other.arrays)
+		{
+			bind(other.arrays.count);
+			other.arrays = Arrays{};
+		}
+		QuantizedPointCloud& operator=(const QuantizedPointCloud& other) {
+			quantized = other.quantized;
+			outputs = other.outputs;
+			arrays = other.arrays;
+			bind(other.arrays.count);
+			return *this;
+		}
+		QuantizedPointCloud& operator=(QuantizedPointCloud&& other) noexcept {
+			quantized = std::move(other.quantized);
+			outputs = std::move(other.outputs);
+			arrays = other.arrays;
+			bind(other.arrays.count);
+			other.arrays = Arrays{};
+			return *this;
+		}
+
+		void assign(const Cloud& cloud) {
+			const std::size_t count = cloud.size();
+			quantized.assign(count * ArraysPerPoint, storage_t(0));
+			outputs.assign(count * OutDim, T(0));
+			bind(count);
+
+			for (int d = 0; d < InDim; ++d) {
+				arrays.positionRange[d] = quantizeArray(cloud, arrays.position[d], [d](const auto& point) { return component(point.position, d); });
+				arrays.domainRange[d] = quantizeArray(cloud, arrays.domain[d], [d](const auto& point) { return component(point.domain, d); });
+				for (int o = 0; o < OutDim; ++o) {
+					arrays.tangentRange[d][o] = quantizeArray(cloud, arrays.tangent[d][o], [d, o](const auto& point) { return component(point.tangent[d], o); });
+				}
+			}
+			for (std::size_t i = 0; i < count; ++i) {
+				for (int o = 0; o < OutDim; ++o) {
+					outputs[o * count + i] = component(cloud[i].output, o);
+				}
+			}
+		}
+
+		std::size_t size() const {
+			return arrays.count;
+		}
+		bool empty() const {
+			return arrays.count == 0;
+		}
+
+		static constexpr int inputDimensions() {
+			return InDim;
+		}
+		static constexpr int outputDimensions() {
+			return OutDim;
+		}
+
+		ovec eval(ivec input) const {
+			std::array<T, InDim> in;
+			for (int d = 0; d < InDim; ++d) {
+				in[d] = component(input, d);
+			}
+
+			std::array<T, OutDim> numerator;
+			T sum = intern::accumulatePointCloudArrays<Kernel, T, InDim, OutDim>(arrays, in, numerator);
+
+			ovec result(0);
+			if (sum > T(0)) {
+				for (int o = 0; o < OutDim; ++o) {
+					component(result, o) = numerator[o] / sum;
+				}
+			}
+			return result;
+		}
+
+		// Evaluate 'count' inputs, writing the results to 'output'.
+		template<typename Policy>
+		void evalBatch(const ivec* input, std::size_t count, ovec* output, const Policy& policy) const {
+			static_assert(ez::is_execution_policy_v<Policy>, "ez::QuantizedPointCloud::evalBatch requires an execution policy!");
+
+			intern::parallelFor(policy, count, [&](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; ++i) {
+					output[i] = eval(input[i]);
+				}
+			});
+		}
+		void evalBatch(const ivec* input, std::size_t count, ovec* output) const {
+			evalBatch(input, count, output, execution::seq);
+		}
+
+		// The arrays and their dequantization ranges, each array has size() values.
+		const Arrays& getArrays() const {
+			return arrays;
+		}
+
+		// Total bytes used by the point data
+		std::size_t memoryUsage() const {
+			return quantized.size() * sizeof(storage_t) + outputs.size() * sizeof(T);
+		}
+	private:
+		// The quantized arrays back to back, in the order position, domain, tangent.
+		std::vector<storage_t> quantized;
+		// The output arrays back to back
+		std::vector<T> outputs;
+		Arrays arrays;
+
+		storage_t* mutableArray(const storage_t* ptr) {
+			return quantized.data() + (ptr - quantized.data());
+		}
+
+		// Quantize one array, returns the range to dequantize it.
+		template<typename Get>
+		Range quantizeArray(const Cloud& cloud, const storage_t* target, Get&& get) {
+			constexpr T levels = static_cast<T>(std::numeric_limits<storage_t>::max());
+			const std::size_t count = cloud.size();
+
+			T lo = std::numeric_limits<T>::max(), hi = std::numeric_limits<T>::lowest();
+			for (std::size_t i = 0; i < count; ++i) {
+				T value = get(cloud[i]);
+				lo = std::min(lo, value);
+				hi = std::max(hi, value);
+			}
+
+			Range range;
+			range.offset = count == 0 ? T(0) : lo;
+			range.scale = hi > lo ? (hi - lo) / levels : T(0);
+
+			storage_t* out = mutableArray(target);
+			for (std::size_t i = 0; i < count; ++i) {
+				T normalized = range.scale > T(0) ? (get(cloud[i]) - lo) / range.scale : T(0);
+				out[i] = static_cast<storage_t>(std::clamp(std::round(normalized), T(0), levels));
+			}
+			return range;
+		}
+
+		// Point the arrays into the buffers, the ranges are left alone.
+		void bind(std::size_t count) {
+			arrays.count = count;
+
+			const storage_t* ptr = quantized.data();
+			for (int d = 0; d < InDim; ++d) {
+				arrays.position[d] = ptr;
+				ptr += count;
+			}
+			for (int d = 0; d < InDim; ++d) {
+				arrays.domain[d] = ptr;
+				ptr += count;
+			}
+			for (int d = 0; d < InDim; ++d) {
+				for (int o = 0; o < OutDim; ++o) {
+					arrays.tangent[d][o] = ptr;
+					ptr += count;
+				}
+			}
+			for (int o = 0; o < OutDim; ++o) {
+				arrays.output[o] = outputs.data() + o * count;
+			}
+		}
+
+		template<typename V>
+		static decltype(auto) component(V& v, int i) {
+			if constexpr (std::is_floating_point_v<std::decay_t<V>>) {
+				assert(i == 0);
+				return (v);
+			}
+			else {
+				return (v[i]);
+			}
+		}
+	};
+};
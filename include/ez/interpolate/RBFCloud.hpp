@@ -0,0 +1,289 @@
+#pragma once
+#include <ez/meta.hpp>
+
+#include <vector>
+#include <cinttypes>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <ez/interpolate/PointCloud.hpp>
+#include <ez/interpolate/Weighting.hpp>
+#include <ez/interpolate/intern/PointCloudTree.hpp>
+
+namespace ez {
+	/*
+	Interpolation with compactly supported radial basis functions (Wendland kernels).
+	The weights are solved once in build, each query then only visits the points within the support radius of the input.
+
+	Unlike PointCloud, only the positions and outputs of the points are used, the domains and tangents are ignored.
+	The result is zero outside of the support of every point, so the support radius should be large enough to cover the gaps in the cloud.
+	*/
+	template<typename T, int InDim, int OutDim>
+	class RBFCloud {
+	public:
+		static_assert(InDim > 0 && InDim <= 4, "Input Dimension is out of range!");
+		static_assert(OutDim > 0 && OutDim <= 4, "Output Dimension is out of range!");
+		static_assert(std::is_floating_point_v<T>, "ez::RBFCloud requires floating point types!");
+
+		using real_t = T;
+		using ovec = std::conditional_t<OutDim == 1, T, glm::vec<OutDim, T>>;
+		using ivec = std::conditional_t<InDim == 1, T, glm::vec<InDim, T>>;
+
+		RBFCloud()
+			: support(T(1))
+			, converged(true)
+		{}
+
+		template<typename Kernel>
+		RBFCloud(const PointCloud<T, InDim, OutDim, Kernel>& cloud, T supportRadius)
+			: RBFCloud()
+		{
+			build(cloud, supportRadius);
+		}
+
+		/*
+		Solve the weights so that the interpolation passes through every point.
+		The system is sparse and positive definite, it is solved with conjugate gradients until
+		the residual is below 'tolerance' (relative to the outputs), or 'maxIterations' is reached (zero means the number of points).
+		Returns false if the solver did not converge, the weights are still usable but the points may not be interpolated exactly.
+		*/
+		bool build(const ivec* positions, const ovec* outputs, std::size_t count, T supportRadius, T tolerance = T(1e-6), std::size_t maxIterations = 0) {
+			assert(supportRadius > T(0));
+			support = supportRadius;
+
+			centers.resize(count);
+			std::vector<T> ones(count, T(1));
+			for (std::size_t i = 0; i < count; ++i) {
+				centers[i] = toArray(positions[i]);
+			}
+			// With unit domains the tree bounds the plain euclidean distance
+			tree.build(centers, ones);
+
+			buildMatrix();
+
+			weights.assign(count * OutDim, T(0));
+			converged = true;
+			if (maxIterations == 0) {
+				maxIterations = std::max(count, std::size_t(1));
+			}
+
+			std::vector<T> rhs(count), solution(count);
+			for (int o = 0; o < OutDim; ++o) {
+				for (std::size_t i = 0; i < count; ++i) {
+					rhs[i] = component(outputs[i], o);
+				}
+				converged = solve(rhs, solution, tolerance, maxIterations) && converged;
+				for (std::size_t i = 0; i < count; ++i) {
+					weights[i * OutDim + o] = solution[i];
+				}
+			}
+
+			// The matrix is only needed for the solve
+			rowStart = {};
+			columns = {};
+			values = {};
+
+			return converged;
+		}
+
+		template<typename Kernel>
+		bool build(const PointCloud<T, InDim, OutDim, Kernel>& cloud, T supportRadius, T tolerance = T(1e-6), std::size_t maxIterations = 0) {
+			std::vector<ivec> positions(cloud.size());
+			std::vector<ovec> outputs(cloud.size());
+			for (std::size_t i = 0; i < cloud.size(); ++i) {
+				positions[i] = cloud[i].position;
+				outputs[i] = cloud[i].output;
+			}
+			return build(positions.data(), outputs.data(), cloud.size(), supportRadius, tolerance, maxIterations);
+		}
+
+		ovec eval(ivec input) const {
+			const std::array<T, InDim> query = toArray(input);
+			const T cutoff = support * support;
+
+			std::array<T, OutDim> result{};
+			tree.search(query, [cutoff]() { return cutoff; }, [&](std::size_t index) {
+				T dist2 = distance2(centers[index], query);
+				if (dist2 < cutoff) {
+					T phi = kernel(std::sqrt(dist2) / support);
+					for (int o = 0; o < OutDim; ++o) {
+						result[o] += weights[index * OutDim + o] * phi;
+					}
+				}
+			});
+
+			ovec value(0);
+			for (int o = 0; o < OutDim; ++o) {
+				component(value, o) = result[o];
+			}
+			return value;
+		}
+
+		// Evaluate 'count' inputs, writing the results to 'output'.
+		template<typename Policy>
+		void evalBatch(const ivec* input, std::size_t count, ovec* output, const Policy& policy) const {
+			static_assert(ez::is_execution_policy_v<Policy>, "ez::RBFCloud::evalBatch requires an execution policy!");
+
+			intern::parallelFor(policy, count, [&](std::size_t first, std::size_t last) {
+				for (std::size_t i = first; i < last; ++i) {
+					output[i] = eval(input[i]);
+				}
+			});
+		}
+		void evalBatch(const ivec* input, std::size_t count, ovec* output) const {
+			evalBatch(input, count, output, execution::seq);
+		}
+
+		std::size_t size() const {
+			return centers.size();
+		}
+		bool empty() const {
+			return centers.empty();
+		}
+
+		T supportRadius() const {
+			return support;
+		}
+
+		// Did the last build converge?
+		bool isConverged() const {
+			return converged;
+		}
+
+		// The Wendland kernel for a distance scaled by the support radius.
+		// weighting::Wendland up to three dimensions, where it is positive definite, and the next smoother one (positive definite up to five) above that.
+		static T kernel(T r) noexcept {
+			if constexpr (InDim <= 3) {
+				return weighting::Wendland::ofDistance(r);
+			}
+			else {
+				if (r >= T(1)) {
+					return T(0);
+				}
+				T s = T(1) - r;
+				T s2 = s * s;
+				return s2 * s2 * s * (T(5) * r + T(1));
+			}
+		}
+	private:
+		using Tree = intern::PointCloudTree<T, InDim>;
+
+		T support;
+		bool converged;
+
+		std::vector<std::array<T, InDim>> centers;
+		// Interleaved, OutDim weights per point
+		std::vector<T> weights;
+		Tree tree;
+
+		// Compressed sparse rows of the kernel matrix, only alive during build.
+		std::vector<std::size_t> rowStart;
+		std::vector<std::uint32_t> columns;
+		std::vector<T> values;
+
+		void buildMatrix() {
+			const std::size_t count = centers.size();
+			const T cutoff = support * support;
+
+			rowStart.assign(1, 0);
+			columns.clear();
+			values.clear();
+
+			for (std::size_t row = 0; row < count; ++row) {
+				tree.search(centers[row], [cutoff]() { return cutoff; }, [&](std::size_t col) {
+					T dist2 = distance2(centers[row], centers[col]);
+					if (dist2 < cutoff) {
+						columns.push_back(static_cast<std::uint32_t>(col));
+						values.push_back(kernel(std::sqrt(dist2) / support));
+					}
+				});
+				rowStart.push_back(columns.size());
+			}
+		}
+
+		void multiply(const std::vector<T>& x, std::vector<T>& out) const {
+			for (std::size_t row = 0; row + 1 < rowStart.size(); ++row) {
+				T total = T(0);
+				for (std::size_t k = rowStart[row]; k < rowStart[row + 1]; ++k) {
+					total += values[k] * x[columns[k]];
+				}
+				out[row] = total;
+			}
+		}
+
+		static T dot(const std::vector<T>& lh, const std::vector<T>& rh) {
+			T total = T(0);
+			for (std::size_t i = 0; i < lh.size(); ++i) {
+				total += lh[i] * rh[i];
+			}
+			return total;
+		}
+
+		// Conjugate gradients, the diagonal of the kernel matrix is always kernel(0) = 1 so no preconditioner is needed.
+		bool solve(const std::vector<T>& rhs, std::vector<T>& x, T tolerance, std::size_t maxIterations) const {
+			const std::size_t count = rhs.size();
+			std::fill(x.begin(), x.end(), T(0));
+
+			std::vector<T> r = rhs, p = rhs, ap(count);
+			T rr = dot(r, r);
+			const T target = tolerance * tolerance * std::max(dot(rhs, rhs), std::numeric_limits<T>::min());
+
+			for (std::size_t iter = 0; iter < maxIterations && rr > target; ++iter) {
+				multiply(p, ap);
+				T pap = dot(p, ap);
+				if (!(pap > T(0))) {
+					return false;
+				}
+
+				T alpha = rr / pap;
+				for (std::size_t i = 0; i < count; ++i) {
+					x[i] += alpha * p[i];
+					r[i] -= alpha * ap[i];
+				}
+
+				T next = dot(r, r);
+				T beta = next / rr;
+				rr = next;
+				for (std::size_t i = 0; i < count; ++i) {
+					p[i] = r[i] + beta * p[i];
+				}
+			}
+			return rr <= target;
+		}
+
+		static T distance2(const std::array<T, InDim>& lh, const std::array<T, InDim>& rh) noexcept {
+			T total = T(0);
+			for (int i = 0; i < InDim; ++i) {
+				T d = lh[i] - rh[i];
+				total += d * d;
+			}
+			return total;
+		}
+
+		static std::array<T, InDim> toArray(const ivec& v) {
+			std::array<T, InDim> result;
+			for (int i = 0; i < InDim; ++i) {
+				result[i] = component(v, i);
+			}
+			return result;
+		}
+
+		template<typename V>
+		static decltype(auto) component(V& v, int i) {
+			if constexpr (std::is_floating_point_v<std::decay_t<V>>) {
+				assert(i == 0);
+				return (v);
+			}
+			else {
+				return (v[i]);
+			}
+		}
+	};
+};
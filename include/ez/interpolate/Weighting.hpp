@@ -0,0 +1,165 @@
+#pragma once
+#include <ez/math/constants.hpp>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <type_traits>
+
+/*
+Weighting kernels for the point clouds.
+The kernels are stateless types with static functions, so they get inlined into the evaluation loops.
+Every kernel is a function of the domain scaled squared distance 'dist2', and provides:
+
+	static T weight(T dist2)       the weight of a point
+	static T derivative(T dist2)   the derivative of the weight with respect to dist2
+	static constexpr T cutoff()    the dist2 at and beyond which the weight is zero, infinity if there is none
+
+A user defined kernel just needs the same three functions, each a template on T. The cutoff must be constexpr, PointCloud uses it in constant expressions.
+
+Kernels may also have a 'static constexpr std::uint32_t id', which is written to the cloud stores so a view with a different kernel will not open them.
+The built in kernels use ids below 0x10000. Kernels without an id are stored as zero.
+*/
+
+namespace ez::weighting {
+	/*
+	Inverse distance weighting, 1 / (eps + distance^P).
+	The weight is infinite at the points, so the points are always interpolated exactly.
+	P = 2 is the default weighting of PointCloud.
+	*/
+	template<int P>
+	struct InversePower {
+		static_assert(P > 0, "ez::weighting::InversePower requires a positive power!");
+
+		static constexpr std::uint32_t id = 0x100 + static_cast<std::uint32_t>(P);
+
+		template<typename T>
+		static T weight(T dist2) noexcept {
+			// We add an epsilion value to prevent division by zero
+			return T(1) / (ez::epsilon<T>() + power(dist2));
+		}
+
+		template<typename T>
+		static T derivative(T dist2) noexcept {
+			T w = weight(dist2);
+			// d/dx of x^(P/2)
+			T dp;
+			if constexpr (P % 2 == 0) {
+				dp = T(P / 2);
+				for (int i = 1; i < P / 2; ++i) {
+					dp *= dist2;
+				}
+			}
+			else {
+				dp = T(P) * T(0.5) * std::pow(dist2, T(P) * T(0.5) - T(1));
+			}
+			return -w * w * dp;
+		}
+
+		template<typename T>
+		static constexpr T cutoff() noexcept {
+			return std::numeric_limits<T>::infinity();
+		}
+
+		template<typename T>
+		static T power(T dist2) noexcept {
+			if constexpr (P % 2 == 0) {
+				T result = T(1);
+				for (int i = 0; i < P / 2; ++i) {
+					result *= dist2;
+				}
+				return result;
+			}
+			else {
+				return std::pow(dist2, T(P) * T(0.5));
+			}
+		}
+	};
+
+	/*
+	Gaussian, exp(-dist2). The domain of the points sets the width.
+	The points are not interpolated exactly, and the result falls to zero far from every point.
+	Weights below exp(-32) are dropped.
+	*/
+	struct Gaussian {
+		static constexpr std::uint32_t id = 0x200;
+
+		template<typename T>
+		static T weight(T dist2) noexcept {
+			return dist2 < cutoff<T>() ? std::exp(-dist2) : T(0);
+		}
+
+		template<typename T>
+		static T derivative(T dist2) noexcept {
+			return -weight(dist2);
+		}
+
+		template<typename T>
+		static constexpr T cutoff() noexcept {
+			return T(32);
+		}
+	};
+
+	/*
+	Wendland C2 kernel, (1 - r)^4 * (4r + 1) where r is the scaled distance.
+	Smooth and exactly zero for r >= 1, so the domain of the points sets the radius of influence.
+	The points are not interpolated exactly, and the result is zero outside of every radius.
+	*/
+	struct Wendland {
+		static constexpr std::uint32_t id = 0x300;
+
+		template<typename T>
+		static T weight(T dist2) noexcept {
+			return dist2 >= T(1) ? T(0) : ofDistance(std::sqrt(dist2));
+		}
+
+		// The kernel as a function of the scaled distance r instead of its square
+		template<typename T>
+		static T ofDistance(T r) noexcept {
+			if (r >= T(1)) {
+				return T(0);
+			}
+			T s = T(1) - r;
+			T s2 = s * s;
+			return s2 * s2 * (T(4) * r + T(1));
+		}
+
+		template<typename T>
+		static T derivative(T dist2) noexcept {
+			if (dist2 >= T(1)) {
+				return T(0);
+			}
+			// dw/dr = -20r(1 - r)^3, and dr/d(dist2) = 1 / 2r
+			T s = T(1) - std::sqrt(dist2);
+			return T(-10) * s * s * s;
+		}
+
+		template<typename T>
+		static constexpr T cutoff() noexcept {
+			return T(1);
+		}
+	};
+
+	namespace intern {
+		template<typename Kernel, typename = void>
+		struct KernelId {
+			static constexpr std::uint32_t value = 0;
+		};
+		template<typename Kernel>
+		struct KernelId<Kernel, std::void_t<decltype(Kernel::id)>> {
+			static constexpr std::uint32_t value = static_cast<std::uint32_t>(Kernel::id);
+		};
+
+		template<typename Kernel, typename T, typename = void>
+		struct HasConstexprCutoff : std::false_type {};
+		template<typename Kernel, typename T>
+		struct HasConstexprCutoff<Kernel, T, std::void_t<std::integral_constant<bool, (Kernel::template cutoff<T>() >= T(0))>>> : std::true_type {};
+	};
+
+	// Does the kernel have a static constexpr cutoff<T>()?
+	template<typename Kernel, typename T>
+	inline constexpr bool has_constexpr_cutoff_v = intern::HasConstexprCutoff<Kernel, T>::value;
+
+	// The id of the kernel, or zero if it does not have one.
+	template<typename Kernel>
+	inline constexpr std::uint32_t kernel_id_v = intern::KernelId<Kernel>::value;
+};
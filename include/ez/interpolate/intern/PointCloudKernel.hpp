@@ -0,0 +1,194 @@
+#pragma once
+#include <cinttypes>
+#include <array>
+#include <type_traits>
+
+namespace ez::intern {
+	// Affine dequantization of a stored value, offset + scale * stored.
+	// The range is taken by value, so it can stay in registers while the loops write to arrays of T.
+	template<typename T>
+	struct QuantizedRange {
+		T offset = T(0);
+		T scale = T(1);
+	};
+
+	template<typename T, typename S>
+	inline T dequantize(S stored, QuantizedRange<T> range) noexcept {
+		return range.offset + range.scale * static_cast<T>(stored);
+	}
+
+	/*
+	Struct of arrays layout for a point cloud, the arrays are not owned.
+	Each array holds one value per point, so the evaluation only streams the fields it actually needs.
+	*/
+	template<typename T, int InDim, int OutDim>
+	struct PointCloudArrays {
+		std::size_t count = 0;
+
+		std::array<const T*, InDim> position{};
+		std::array<const T*, InDim> domain{};
+		// tangent[i][o] is component 'o' of the tangent along input dimension 'i'
+		std::array<std::array<const T*, OutDim>, InDim> tangent{};
+		std::array<const T*, OutDim> output{};
+	};
+
+	/*
+	Same layout with the positions, domains and tangents stored as the integer type S.
+	Each array has its own range to dequantize it, the outputs are kept as T.
+	*/
+	template<typename T, typename S, int InDim, int OutDim>
+	struct QuantizedPointCloudArrays {
+		std::size_t count = 0;
+
+		std::array<const S*, InDim> position{};
+		std::array<const S*, InDim> domain{};
+		std::array<std::array<const S*, OutDim>, InDim> tangent{};
+		std::array<const T*, OutDim> output{};
+
+		std::array<QuantizedRange<T>, InDim> positionRange{};
+		std::array<QuantizedRange<T>, InDim> domainRange{};
+		std::array<std::array<QuantizedRange<T>, OutDim>, InDim> tangentRange{};
+	};
+
+	// The number of points processed together by the kernels.
+	// The inner loops run over the lanes with no dependencies between them, so the compiler can vectorize them.
+	inline constexpr std::size_t CloudLanes = 8;
+
+	// The number of points dequantized at a time by the quantized kernel, small enough that the scratch arrays stay in L1.
+	inline constexpr std::size_t QuantizedCloudBlock = 128;
+
+	/*
+	Fused weight and accumulate over the arrays, using the weighting Kernel (see Weighting.hpp).
+	Writes the weighted sum of the outputs into 'numerator' and returns the sum of the weights.
+	*/
+	template<typename Kernel, typename T, int InDim, int OutDim>
+	T accumulatePointCloudArrays(const PointCloudArrays<T, InDim, OutDim>& arrays, const std::array<T, InDim>& input, std::array<T, OutDim>& numerator) {
+		constexpr std::size_t L = CloudLanes;
+
+		std::array<T, L> sum{};
+		std::array<std::array<T, L>, OutDim> acc{};
+
+		std::size_t first = 0;
+		for (; first < arrays.count; first += L) {
+			const std::size_t n = (arrays.count - first) < L ? (arrays.count - first) : L;
+
+			std::array<std::array<T, L>, InDim> delta;
+			std::array<T, L> weight{};
+
+			if (n == L) {
+				for (int d = 0; d < InDim; ++d) {
+					const T* pos = arrays.position[d] + first;
+					const T* dom = arrays.domain[d] + first;
+					for (std::size_t l = 0; l < L; ++l) {
+						T diff = input[d] - pos[l];
+						delta[d][l] = diff;
+						weight[l] += dom[l] * diff * diff;
+					}
+				}
+				for (std::size_t l = 0; l < L; ++l) {
+					weight[l] = Kernel::weight(weight[l]);
+					sum[l] += weight[l];
+				}
+				for (int o = 0; o < OutDim; ++o) {
+					const T* out = arrays.output[o] + first;
+
+					std::array<T, L> value;
+					for (std::size_t l = 0; l < L; ++l) {
+						value[l] = out[l];
+					}
+					for (int d = 0; d < InDim; ++d) {
+						const T* tan = arrays.tangent[d][o] + first;
+						for (std::size_t l = 0; l < L; ++l) {
+							value[l] += tan[l] * delta[d][l];
+						}
+					}
+					for (std::size_t l = 0; l < L; ++l) {
+						acc[o][l] += value[l] * weight[l];
+					}
+				}
+			}
+			else {
+				// Remainder, same math one point at a time.
+				for (std::size_t l = 0; l < n; ++l) {
+					std::size_t i = first + l;
+
+					T dist2 = T(0);
+					for (int d = 0; d < InDim; ++d) {
+						T diff = input[d] - arrays.position[d][i];
+						delta[d][l] = diff;
+						dist2 += arrays.domain[d][i] * diff * diff;
+					}
+					T w = Kernel::weight(dist2);
+					sum[l] += w;
+
+					for (int o = 0; o < OutDim; ++o) {
+						T value = arrays.output[o][i];
+						for (int d = 0; d < InDim; ++d) {
+							value += arrays.tangent[d][o][i] * delta[d][l];
+						}
+						acc[o][l] += value * w;
+					}
+				}
+			}
+		}
+
+		T total = T(0);
+		for (std::size_t l = 0; l < L; ++l) {
+			total += sum[l];
+		}
+		for (int o = 0; o < OutDim; ++o) {
+			T value = T(0);
+			for (std::size_t l = 0; l < L; ++l) {
+				value += acc[o][l];
+			}
+			numerator[o] = value;
+		}
+		return total;
+	}
+
+	/*
+	The quantized version, each block of points is dequantized into scratch arrays and then accumulated by the kernel above.
+	The conversions are plain loops over contiguous arrays, so they vectorize on their own and the math is shared with the full precision path.
+	*/
+	template<typename Kernel, typename T, int InDim, int OutDim, typename S>
+	T accumulatePointCloudArrays(const QuantizedPointCloudArrays<T, S, InDim, OutDim>& arrays, const std::array<T, InDim>& input, std::array<T, OutDim>& numerator) {
+		constexpr std::size_t B = QuantizedCloudBlock;
+
+		std::array<T, B> position[InDim], domain[InDim], tangent[InDim][OutDim];
+		auto convert = [](const S* src, QuantizedRange<T> range, std::size_t n, T* dest) {
+			for (std::size_t i = 0; i < n; ++i) {
+				dest[i] = dequantize(src[i], range);
+			}
+		};
+
+		T total = T(0);
+		numerator.fill(T(0));
+
+		for (std::size_t first = 0; first < arrays.count; first += B) {
+			const std::size_t n = (arrays.count - first) < B ? (arrays.count - first) : B;
+
+			PointCloudArrays<T, InDim, OutDim> block;
+			block.count = n;
+			for (int d = 0; d < InDim; ++d) {
+				convert(arrays.position[d] + first, arrays.positionRange[d], n, position[d].data());
+				convert(arrays.domain[d] + first, arrays.domainRange[d], n, domain[d].data());
+				block.position[d] = position[d].data();
+				block.domain[d] = domain[d].data();
+				for (int o = 0; o < OutDim; ++o) {
+					convert(arrays.tangent[d][o] + first, arrays.tangentRange[d][o], n, tangent[d][o].data());
+					block.tangent[d][o] = tangent[d][o].data();
+				}
+			}
+			for (int o = 0; o < OutDim; ++o) {
+				block.output[o] = arrays.output[o] + first;
+			}
+
+			std::array<T, OutDim> partial;
+			total += accumulatePointCloudArrays<Kernel, T, InDim, OutDim>(block, input, partial);
+			for (int o = 0; o < OutDim; ++o) {
+				numerator[o] += partial[o];
+			}
+		}
+		return total;
+	}
+};
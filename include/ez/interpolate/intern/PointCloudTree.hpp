@@ -0,0 +1,183 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cinttypes>
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace ez::intern {
+	/*
+	k-d tree over the positions of a point cloud.
+	The tree does not own the points, it only stores a permutation of their indices and the node bounds.
+	Each node also stores the smallest domain value of the points below it, so that queries can bound the
+	domain scaled distance that the point clouds use, instead of just the euclidean distance.
+	*/
+	template<typename T, int Dim>
+	class PointCloudTree {
+	public:
+		using real_t = T;
+		using position_t = std::array<T, Dim>;
+
+		static constexpr std::size_t LeafSize = 8;
+
+		struct Node {
+			position_t lo, hi;
+			// Smallest domain component of all the points in this node.
+			T minDomain;
+			// Range into the permutation
+			std::uint32_t begin, end;
+			// Child nodes, -1 for a leaf.
+			std::int32_t left, right;
+		};
+
+		void clear() {
+			nodes.clear();
+			order.clear();
+		}
+
+		bool empty() const {
+			return nodes.empty();
+		}
+
+		// Build the tree, positions and domains are indexed by point.
+		// minDomains[i] is the smallest component of the domain of point i.
+		void build(const std::vector<position_t>& positions, const std::vector<T>& minDomains) {
+			assert(positions.size() == minDomains.size());
+			assert(positions.size() < std::numeric_limits<std::uint32_t>::max());
+
+			clear();
+			if (positions.empty()) {
+				return;
+			}
+
+			order.resize(positions.size());
+			std::iota(order.begin(), order.end(), std::uint32_t(0));
+
+			nodes.reserve(2 * (positions.size() / LeafSize + 1));
+			buildNode(positions, minDomains, 0, static_cast<std::uint32_t>(positions.size()));
+		}
+
+		// Squared euclidean distance from the query to the bounds of a node, zero when inside.
+		static T boxDistance2(const Node& node, const position_t& query) noexcept {
+			T total = T(0);
+			for (int i = 0; i < Dim; ++i) {
+				T d = T(0);
+				if (query[i] < node.lo[i]) {
+					d = node.lo[i] - query[i];
+				}
+				else if (query[i] > node.hi[i]) {
+					d = query[i] - node.hi[i];
+				}
+				total += d * d;
+			}
+			return total;
+		}
+
+		/*
+		Visit the points that may be closer than the cutoff, nearest nodes first.
+		'cutoff()' returns the current largest domain scaled squared distance of interest, it may shrink as points are visited.
+		'visit(index)' is called with the original index of each point that is not pruned.
+		*/
+		template<typename Cutoff, typename Visit>
+		void search(const position_t& query, Cutoff&& cutoff, Visit&& visit) const {
+			if (nodes.empty()) {
+				return;
+			}
+
+			// Pending nodes, along with their lower bound distance
+			std::array<std::pair<std::int32_t, T>, 64> stack;
+			std::size_t top = 0;
+			stack[top++] = { 0, lowerBound(nodes[0], query) };
+
+			while (top != 0) {
+				auto [index, bound] = stack[--top];
+				if (bound > cutoff()) {
+					continue;
+				}
+
+				const Node& node = nodes[index];
+				if (node.left < 0) {
+					for (std::uint32_t i = node.begin; i < node.end; ++i) {
+						visit(static_cast<std::size_t>(order[i]));
+					}
+					continue;
+				}
+
+				T lb = lowerBound(nodes[node.left], query);
+				T rb = lowerBound(nodes[node.right], query);
+
+				// Push the farther node first, so the nearer node gets visited first.
+				assert(top + 2 <= stack.size());
+				if (lb < rb) {
+					stack[top++] = { node.right, rb };
+					stack[top++] = { node.left, lb };
+				}
+				else {
+					stack[top++] = { node.left, lb };
+					stack[top++] = { node.right, rb };
+				}
+			}
+		}
+
+		const std::vector<Node>& getNodes() const {
+			return nodes;
+		}
+		// The point indices, in tree order
+		const std::vector<std::uint32_t>& getOrder() const {
+			return order;
+		}
+	private:
+		std::vector<Node> nodes;
+		std::vector<std::uint32_t> order;
+
+		static T lowerBound(const Node& node, const position_t& query) noexcept {
+			return std::max(node.minDomain, T(0)) * boxDistance2(node, query);
+		}
+
+		std::int32_t buildNode(const std::vector<position_t>& positions, const std::vector<T>& minDomains, std::uint32_t begin, std::uint32_t end) {
+			std::int32_t index = static_cast<std::int32_t>(nodes.size());
+			nodes.emplace_back();
+
+			Node node;
+			node.begin = begin;
+			node.end = end;
+			node.left = -1;
+			node.right = -1;
+			node.lo = positions[order[begin]];
+			node.hi = node.lo;
+			node.minDomain = minDomains[order[begin]];
+
+			for (std::uint32_t i = begin + 1; i < end; ++i) {
+				const position_t& p = positions[order[i]];
+				for (int d = 0; d < Dim; ++d) {
+					node.lo[d] = std::min(node.lo[d], p[d]);
+					node.hi[d] = std::max(node.hi[d], p[d]);
+				}
+				node.minDomain = std::min(node.minDomain, minDomains[order[i]]);
+			}
+
+			if (end - begin > LeafSize) {
+				// Split the widest dimension at the median
+				int axis = 0;
+				for (int d = 1; d < Dim; ++d) {
+					if ((node.hi[d] - node.lo[d]) > (node.hi[axis] - node.lo[axis])) {
+						axis = d;
+					}
+				}
+
+				std::uint32_t mid = begin + (end - begin) / 2;
+				std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](std::uint32_t a, std::uint32_t b) {
+					return positions[a][axis] < positions[b][axis];
+				});
+
+				node.left = buildNode(positions, minDomains, begin, mid);
+				node.right = buildNode(positions, minDomains, mid, end);
+			}
+
+			nodes[index] = node;
+			return index;
+		}
+	};
+};
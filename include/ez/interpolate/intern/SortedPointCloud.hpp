@@ -1,15 +1,20 @@
 #pragma once
 #include <ez/meta.hpp>
 #include <vector>
+#include <array>
+#include <iterator>
 #include <cinttypes>
 #include <cassert>
 #include <cmath>
 #include <algorithm>
 #include <type_traits>
+#include <limits>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
+#include <ez/interpolate/Execution.hpp>
+
 namespace ez {
 	namespace intern {
 		template<typename real_t, typename vec_t>
@@ -25,6 +30,217 @@ namespace ez {
 		static bool operator>(const Dist<real_t, vec_t>& left, const Dist<real_t, vec_t>& right) {
 			return left.value > right.value;
 		};
+
+		// The number of knots processed together by the sorted point cloud kernel
+		inline constexpr std::size_t SortedKnotBlock = 64;
+		// Points with fewer knots than this use a plain loop, the blocks only pay off once they are mostly full
+		inline constexpr std::size_t SortedKnotMinBlocked = 32;
+
+		// SortedPointCloud::evalBatch evaluates this many queries against each block of points,
+		// with the blocks of points sized so that their knots stay in the cache between the queries.
+		inline constexpr std::size_t SortedQueryBlock = 32;
+		inline constexpr std::size_t SortedPointBlockBytes = 64 * 1024;
+
+		/*
+		The blocked version of sortedPointKnots, for points with at least SortedKnotMinBlocked knots.
+		The per knot math is done in blocks with no dependencies between the knots, so the compiler can vectorize it.
+		*/
+		template<typename real_t, typename vec_t>
+		real_t sortedPointKnotsBlocked(const real_t* knotPosition, const real_t* knotDomain, const vec_t* knotTangent, std::size_t count, const real_t* input, vec_t& position) {
+			constexpr std::size_t B = SortedKnotBlock;
+			constexpr std::size_t L = 8;
+
+			std::array<real_t, L> dist{};
+			std::array<real_t, B> falloff;
+
+			for (std::size_t first = 0; first < count; first += B) {
+				const std::size_t n = std::min(B, count - first);
+				const real_t* pos = knotPosition + first;
+				const real_t* dom = knotDomain + first;
+				const real_t* in = input + first;
+
+				std::size_t k = 0;
+				for (; k + L <= n; k += L) {
+					for (std::size_t l = 0; l < L; ++l) {
+						// The domain scaling occurs only along this particular knots dimension.
+						real_t tmp = pos[k + l] - in[k + l];
+						tmp = tmp * tmp;
+						dist[l] += dom[k + l] * tmp;
+						falloff[k + l] = real_t(1) - real_t(1) / (tmp * tmp + real_t(1));
+					}
+				}
+				for (; k < n; ++k) {
+					real_t tmp = pos[k] - in[k];
+					tmp = tmp * tmp;
+					dist[0] += dom[k] * tmp;
+					falloff[k] = real_t(1) - real_t(1) / (tmp * tmp + real_t(1));
+				}
+
+				// Split the sum to shorten the dependency chain
+				const vec_t* tan = knotTangent + first;
+				vec_t offset0(0), offset1(0);
+				for (k = 0; k + 2 <= n; k += 2) {
+					offset0 += tan[k] * falloff[k];
+					offset1 += tan[k + 1] * falloff[k + 1];
+				}
+				if (k < n) {
+					offset0 += tan[k] * falloff[k];
+				}
+				position += offset0 + offset1;
+			}
+
+			real_t total = real_t(0);
+			for (std::size_t l = 0; l < L; ++l) {
+				total += dist[l];
+			}
+			return total;
+		}
+
+		// The plain loop version of sortedPointKnots, for points with few knots.
+		template<typename real_t, typename vec_t>
+		real_t sortedPointKnotsShort(const real_t* knotPosition, const real_t* knotDomain, const vec_t* knotTangent, std::size_t count, const real_t* input, vec_t& position) {
+			real_t total = real_t(0);
+			vec_t offset(0);
+			for (std::size_t k = 0; k < count; ++k) {
+				real_t tmp = knotPosition[k] - input[k];
+				tmp = tmp * tmp;
+				total += knotDomain[k] * tmp;
+				offset += knotTangent[k] * (real_t(1) - real_t(1) / (tmp * tmp + real_t(1)));
+			}
+			position += offset;
+			return total;
+		}
+
+		/*
+		Evaluate the knots of a single point of a SortedPointCloud, the knot fields are each contiguous arrays of 'count' values.
+		Adds the tangent offsets to 'position', and returns the domain scaled squared distance to the input.
+		*/
+		template<typename real_t, typename vec_t>
+		real_t sortedPointKnots(const real_t* knotPosition, const real_t* knotDomain, const vec_t* knotTangent, std::size_t count, const real_t* input, vec_t& position) {
+			if (count < SortedKnotMinBlocked) {
+				return sortedPointKnotsShort(knotPosition, knotDomain, knotTangent, count, input, position);
+			}
+			return sortedPointKnotsBlocked(knotPosition, knotDomain, knotTangent, count, input, position);
+		}
+
+		// Weight of a point of a SortedPointCloud, given its domain scaled squared distance
+		template<typename real_t>
+		real_t sortedPointWeight(real_t dist) noexcept {
+			return real_t(1) / (real_t(0.00001) + dist);
+		}
+
+		// Evaluate a whole SortedPointCloud from its flat arrays, 'input' has 'inputs' values.
+		template<typename real_t, typename vec_t>
+		vec_t sortedPointCloudEval(const vec_t* values, const real_t* knotPosition, const real_t* knotDomain, const vec_t* knotTangent, std::size_t points, std::size_t inputs, const real_t* input) {
+			vec_t result(0);
+			real_t sum = real_t(0);
+
+			// Pick the knot loop once for the whole cloud, every point has the same number of knots.
+			auto accumulate = [&](auto&& knots) {
+				for (std::size_t p = 0; p < points; ++p) {
+					vec_t position = values[p];
+					const std::size_t row = p * inputs;
+
+					real_t value = knots(knotPosition + row, knotDomain + row, knotTangent + row, inputs, input, position);
+					value = sortedPointWeight(value);
+
+					result += position * value;
+					sum += value;
+				}
+			};
+			if (inputs < SortedKnotMinBlocked) {
+				accumulate(sortedPointKnotsShort<real_t, vec_t>);
+			}
+			else {
+				accumulate(sortedPointKnotsBlocked<real_t, vec_t>);
+			}
+
+			if (sum >= real_t(1E-5)) {
+				result /= sum;
+			}
+
+			return result;
+		}
+
+		// Random access iterator over proxy references, 'source.refAt(index)' creates the reference.
+		template<typename Source, typename Ref>
+		class ProxyIterator {
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = Ref;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = Ref;
+
+			ProxyIterator()
+				: source{}
+				, index(0)
+			{}
+			ProxyIterator(Source _source, difference_type _index)
+				: source(_source)
+				, index(_index)
+			{}
+
+			Ref operator*() const {
+				return source.refAt(index);
+			}
+			Ref operator[](difference_type n) const {
+				return source.refAt(index + n);
+			}
+
+			ProxyIterator& operator++() {
+				++index;
+				return *this;
+			}
+			ProxyIterator operator++(int) {
+				ProxyIterator copy = *this;
+				++index;
+				return copy;
+			}
+			ProxyIterator& operator--() {
+				--index;
+				return *this;
+			}
+			ProxyIterator operator--(int) {
+				ProxyIterator copy = *this;
+				--index;
+				return copy;
+			}
+			ProxyIterator& operator+=(difference_type n) {
+				index += n;
+				return *this;
+			}
+			ProxyIterator& operator-=(difference_type n) {
+				index -= n;
+				return *this;
+			}
+			ProxyIterator operator+(difference_type n) const {
+				return ProxyIterator{ source, index + n };
+			}
+			ProxyIterator operator-(difference_type n) const {
+				return ProxyIterator{ source, index - n };
+			}
+			difference_type operator-(const ProxyIterator& other) const {
+				return index - other.index;
+			}
+
+			bool operator==(const ProxyIterator& other) const {
+				return index == other.index;
+			}
+			bool operator!=(const ProxyIterator& other) const {
+				return index != other.index;
+			}
+			bool operator<(const ProxyIterator& other) const {
+				return index < other.index;
+			}
+
+			difference_type position() const {
+				return index;
+			}
+		private:
+			Source source;
+			difference_type index;
+		};
 	};
 
 	/*
@@ -32,12 +248,17 @@ namespace ez {
 	There can be as many input dimensions as needed.
 	Manipulating point clouds locally is easier than manipulating bezier curves, its just the transistions to new region on the cloud that is more difficult
 	Derivatives can be calculated easily using automatic differentiation.
+
+	The knots of all the points are stored together, as separate row major (point, input) arrays for each knot field.
+	Points and knots are accessed through lightweight proxies that refer back into those arrays.
+
+	buildIndex sorts the knots of each input by position, evalCutoff then only visits the points near the input.
 	*/
 	template<typename vec_t>
 	class SortedPointCloud {
 	public:
 		static_assert(ez::is_vec_v<vec_t>, "SortedPointCloud requires a vector type!");
-		
+
 		using index_t = std::intptr_t;
 		using size_t = std::size_t;
 
@@ -64,228 +285,703 @@ namespace ez {
 			// The tangent for this knot, defines the direction the evaluated position is offset when approaching this knot.
 			vec_t tangent;
 		};
-		class Point {
+
+		// Reference to a knot stored in the cloud
+		template<bool Const>
+		class BasicKnotRef {
 		public:
-			using iterator = typename std::vector<Knot>::iterator;
-			using const_iterator = typename std::vector<Knot>::const_iterator;
+			template<typename U>
+			using qualified_t = std::conditional_t<Const, const U, U>;
 
-			Point()
-				: value(0)
+			BasicKnotRef(qualified_t<real_t>& _position, qualified_t<real_t>& _domain, qualified_t<vec_t>& _tangent)
+				: position(_position)
+				, domain(_domain)
+				, tangent(_tangent)
 			{}
-			Point(vec_t val, index_t count)
-				: value(val)
-				, knots(count)
+			BasicKnotRef(const BasicKnotRef&) = default;
+
+			// Mutable references convert to const references
+			template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+			BasicKnotRef(const BasicKnotRef<OtherConst>& other)
+				: position(other.position)
+				, domain(other.domain)
+				, tangent(other.tangent)
 			{}
 
-			vec_t value;
+			// Assignment writes through to the cloud
+			template<bool IsConst = Const, typename = std::enable_if_t<!IsConst>>
+			BasicKnotRef& operator=(const Knot& knot) {
+				position = knot.position;
+				domain = knot.domain;
+				tangent = knot.tangent;
+				return *this;
+			}
+			BasicKnotRef& operator=(const BasicKnotRef& other) {
+				static_assert(!Const, "ez::SortedPointCloud::ConstKnotRef cannot be assigned to!");
+				return *this = Knot(other);
+			}
 
-			Knot& operator[](std::intptr_t index) {
-				assert(index >= 0 && index < size());
-				return knots[index];
+			operator Knot() const {
+				Knot knot;
+				knot.position = position;
+				knot.domain = domain;
+				knot.tangent = tangent;
+				return knot;
 			}
-			const Knot& operator[](std::intptr_t index) const {
-				assert(index >= 0 && index < size());
-				return knots[index];
+
+			qualified_t<real_t>& position;
+			qualified_t<real_t>& domain;
+			qualified_t<vec_t>& tangent;
+		};
+		using KnotRef = BasicKnotRef<false>;
+		using ConstKnotRef = BasicKnotRef<true>;
+
+		// Reference to a point stored in the cloud, along with its knots.
+		template<bool Const>
+		class BasicPoint {
+		public:
+			using Cloud = std::conditional_t<Const, const SortedPointCloud, SortedPointCloud>;
+			using KnotReference = BasicKnotRef<Const>;
+			using iterator = intern::ProxyIterator<BasicPoint, KnotReference>;
+			using const_iterator = iterator;
+
+			BasicPoint()
+				: cloud(nullptr)
+				, index(0)
+			{}
+			BasicPoint(Cloud& _cloud, index_t _index)
+				: cloud(&_cloud)
+				, index(_index)
+			{}
+
+			// Mutable points convert to const points
+			template<bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+			BasicPoint(const BasicPoint<OtherConst>& other)
+				: cloud(other.cloud)
+				, index(other.index)
+			{}
+
+			// The output value of the point
+			std::conditional_t<Const, const vec_t, vec_t>& value() const {
+				return cloud->values[index];
+			}
+
+			KnotReference operator[](index_t input) const {
+				assert(input >= 0 && input < size());
+				return cloud->knotAt(index, input);
 			}
 			index_t size() const {
-				return static_cast<std::intptr_t>(knots.size());
+				return cloud->numInputs();
 			}
 
-			iterator begin() {
-				return knots.begin();
-			}
-			iterator end() {
-				return knots.end();
+			iterator begin() const {
+				return iterator{ *this, 0 };
 			}
-			
-			const_iterator begin() const {
-				return knots.begin();
+			iterator end() const {
+				return iterator{ *this, size() };
 			}
-			const_iterator end() const {
-				return knots.end();
+
+			// The index of this point in the cloud
+			index_t pointIndex() const {
+				return index;
 			}
 		private:
-			friend class SortedPointCloud;
-			std::vector<Knot> knots;
+			template<bool> friend class BasicPoint;
+			template<typename, typename> friend class intern::ProxyIterator;
+
+			Cloud* cloud;
+			index_t index;
+
+			KnotReference refAt(std::ptrdiff_t input) const {
+				return (*this)[input];
+			}
+		};
+		using Point = BasicPoint<false>;
+		using ConstPoint = BasicPoint<true>;
+
+	private:
+		// Source of the point references for the iterators
+		template<bool Const>
+		struct PointSource {
+			using Cloud = std::conditional_t<Const, const SortedPointCloud, SortedPointCloud>;
+			Cloud* cloud = nullptr;
+
+			BasicPoint<Const> refAt(std::ptrdiff_t index) const {
+				return (*cloud)[index];
+			}
 		};
+	public:
+		using iterator = intern::ProxyIterator<PointSource<false>, Point>;
+		using const_iterator = intern::ProxyIterator<PointSource<true>, ConstPoint>;
 
-		using container_t = std::vector<Point>;
-		using iterator = typename container_t::iterator;
-		using const_iterator = typename container_t::const_iterator;
-		
 		SortedPointCloud(const SortedPointCloud&) = default;
 		SortedPointCloud(SortedPointCloud&&) noexcept = default;
 		SortedPointCloud& operator=(const SortedPointCloud&) = default;
 		SortedPointCloud& operator=(SortedPointCloud&&) noexcept = default;
-		
+
 		SortedPointCloud()
 			: inputs(0)
+			, indexDirty(true)
 		{}
 
 		SortedPointCloud(index_t pointCount, index_t inputCount)
-			: inputs(inputCount)
-			, points(pointCount, Point(vec_t{0}, inputCount))
-		{}
+			: inputs(0)
+			, indexDirty(true)
+		{
+			resizeInputs(inputCount);
+			resizePoints(pointCount);
+		}
 
 		void setKnot(index_t pointIndex, index_t inputIndex, Knot value) {
 			getKnot(pointIndex, inputIndex) = value;
 		}
 
-		Knot& getKnot(index_t pointIndex, index_t inputIndex) {
+		KnotRef getKnot(index_t pointIndex, index_t inputIndex) {
 			assert(pointIndex >= 0 && pointIndex < numPoints());
 			assert(inputIndex >= 0 && inputIndex < numInputs());
+			indexDirty = true;
 
-			return points[pointIndex].knots[inputIndex];
+			return knotAt(pointIndex, inputIndex);
 		}
-		const Knot& getKnot(index_t pointIndex, index_t inputIndex) const {
+		ConstKnotRef getKnot(index_t pointIndex, index_t inputIndex) const {
 			assert(pointIndex >= 0 && pointIndex < numPoints());
 			assert(inputIndex >= 0 && inputIndex < numInputs());
 
-			return points[pointIndex].knots[inputIndex];
+			return knotAt(pointIndex, inputIndex);
 		}
 
 		void push_back(vec_t value) {
-			points.push_back(Point(value, inputs));
+			insertPoint(numPoints(), value);
 		}
 		void append(vec_t value) {
-			points.push_back(Point(value, inputs));
+			insertPoint(numPoints(), value);
 		}
 		void pop_back() {
-			points.pop_back();
+			assert(numPoints() > 0);
+			erasePoint(numPoints() - 1);
 		}
 		void erase(const_iterator iter) {
-			points.erase(iter);
+			erasePoint(iter.position());
+		}
+		void erase(iterator iter) {
+			erasePoint(iter.position());
 		}
 		void insert(iterator iter, vec_t value) {
-			points.insert(iter, Point(value, inputs));
+			insertPoint(iter.position(), value);
 		}
 		void resizePoints(index_t count) {
 			assert(count >= 0);
+			indexDirty = true;
 
-			index_t excess = count - points.size();
-			if (excess < 0) { // There are now less points.
-				points.resize(count);
-			}
-			else { // There are now more points
-				for (index_t i = 0; i < excess; ++i) {
-					points.push_back(Point{ vec_t{0}, inputs });
-				}
-			}
+			const size_t total = static_cast<size_t>(count) * static_cast<size_t>(inputs);
+			values.resize(count, vec_t{ 0 });
+			knotPositions.resize(total, Knot{}.position);
+			knotDomains.resize(total, Knot{}.domain);
+			knotTangents.resize(total, Knot{}.tangent);
 		}
 
 		void resizeInputs(index_t count) {
 			assert(count >= 0);
-			
-			for (Point& point : points) {
-				point.knots.resize(count);
+			if (count == inputs) {
+				return;
 			}
+			indexDirty = true;
+
+			// The arrays are row major, so every row has to move.
+			const size_t points = values.size();
+			const size_t keep = static_cast<size_t>(std::min(count, inputs));
+			std::vector<real_t> positions(points * count, Knot{}.position);
+			std::vector<real_t> domains(points * count, Knot{}.domain);
+			std::vector<vec_t> tangents(points * count, Knot{}.tangent);
+
+			for (size_t p = 0; p < points; ++p) {
+				size_t from = p * inputs, to = p * count;
+				std::copy_n(knotPositions.begin() + from, keep, positions.begin() + to);
+				std::copy_n(knotDomains.begin() + from, keep, domains.begin() + to);
+				std::copy_n(knotTangents.begin() + from, keep, tangents.begin() + to);
+			}
+
+			knotPositions = std::move(positions);
+			knotDomains = std::move(domains);
+			knotTangents = std::move(tangents);
 			inputs = count;
 		}
 
-		Point& operator[](std::intptr_t index) {
+		Point operator[](std::intptr_t index) {
 			assert(index >= 0 && index < numPoints());
-			return points[index];
+			indexDirty = true;
+			return Point{ *this, index };
 		}
-		const Point& operator[](std::intptr_t index) const {
+		ConstPoint operator[](std::intptr_t index) const {
 			assert(index >= 0 && index < numPoints());
-			return points[index];
+			return ConstPoint{ *this, index };
 		}
 
 		vec_t& getPoint(index_t index) {
 			assert(index >= 0 && index < numPoints());
-			return points[index].value;
+			return values[index];
 		}
 		const vec_t& getPoint(index_t index) const {
 			assert(index >= 0 && index < numPoints());
-			return points[index].value;
+			return values[index];
 		}
 		void setPoint(index_t index, vec_t point) {
 			assert(index >= 0 && index < numPoints());
-			points[index].value = point;
+			values[index] = point;
 		}
 
 		index_t size() const {
-			return static_cast<index_t>(points.size());
+			return static_cast<index_t>(values.size());
 		}
 		index_t numPoints() const {
-			return static_cast<index_t>(points.size());
+			return static_cast<index_t>(values.size());
 		}
 		index_t numInputs() const {
 			return inputs;
 		}
 
 		void clear() {
-			points.clear();
+			values.clear();
+			knotPositions.clear();
+			knotDomains.clear();
+			knotTangents.clear();
 			inputs = 0;
+			indexDirty = true;
 		}
 
 		iterator begin() {
-			return points.begin();
+			indexDirty = true;
+			return iterator{ PointSource<false>{ this }, 0 };
 		}
 		iterator end() {
-			return points.end();
+			indexDirty = true;
+			return iterator{ PointSource<false>{ this }, size() };
 		}
 
 		const_iterator begin() const {
-			return points.begin();
+			return const_iterator{ PointSource<true>{ this }, 0 };
 		}
 		const_iterator end() const {
-			return points.end();
+			return const_iterator{ PointSource<true>{ this }, size() };
 		}
-	private:
-		index_t inputs;
-		// The interpolation points.
-		std::vector<Point> points;
 
-		template<typename Iter>
-		vec_t evalImpl(Iter inFirst, Iter inLast) const {
+		/*
+		Build the per input sorted knot indices used by evalCutoff.
+		Any non-const access to the points or knots invalidates the index (the point values do not matter), so call this again after editing the cloud.
+		*/
+		void buildIndex() {
+			const size_t count = values.size();
+			const size_t m = static_cast<size_t>(inputs);
+			assert(count < std::numeric_limits<std::uint32_t>::max());
+
+			sortedPoints.resize(count * m);
+			sortedPositions.resize(count * m);
+			minDomains.assign(m, std::numeric_limits<real_t>::infinity());
+
+			for (size_t k = 0; k < m; ++k) {
+				std::uint32_t* order = sortedPoints.data() + k * count;
+				for (size_t p = 0; p < count; ++p) {
+					order[p] = static_cast<std::uint32_t>(p);
+					minDomains[k] = std::min(minDomains[k], knotDomains[p * m + k]);
+				}
+				std::sort(order, order + count, [&](std::uint32_t lh, std::uint32_t rh) {
+					return knotPositions[lh * m + k] < knotPositions[rh * m + k];
+				});
+				for (size_t p = 0; p < count; ++p) {
+					sortedPositions[k * count + p] = knotPositions[order[p] * m + k];
+				}
+			}
+			indexDirty = false;
+		}
+
+		// Is there an up to date index?
+		bool hasIndex() const {
+			return !indexDirty;
+		}
+
+		// Details of an evalCutoff call
+		struct CutoffStats {
+			// Points whose distance was checked, and points that were blended
+			size_t visited = 0;
+			size_t included = 0;
+
+			// Sum of the weights of the blended points
+			real_t includedWeight = real_t(0);
+			// Upper bound on the sum of the weights of the dropped points
+			real_t droppedWeight = real_t(0);
+
+			/*
+			Upper bound on the fraction of the total weight that was dropped.
+			The result is off from eval by at most this fraction of the largest distance between any two tangent offset point values.
+			*/
+			real_t errorBound() const {
+				real_t total = includedWeight + droppedWeight;
+				return total > real_t(0) ? droppedWeight / total : real_t(0);
+			}
+		};
+
+		/*
+		Evaluate, skipping the points whose domain scaled squared distance to the input is above 'cutoff'.
+		Each dropped point has a weight of at most 1 / (0.00001 + cutoff), see CutoffStats for the resulting error bound.
+		With an up to date index, only the points within the cutoff along the most selective input are visited, this assumes the domains are not negative.
+		Without one, every point is visited but the distance calculation stops as soon as the cutoff is passed.
+		*/
+		vec_t evalCutoff(const real_t* input, real_t cutoff, CutoffStats* stats = nullptr) const {
 			using namespace ez::intern;
 
-			vec_t result(0);
-			real_t sum = real_t(0);
+			const size_t count = values.size();
+			const size_t m = static_cast<size_t>(inputs);
 
-			// Calculate all the distances
-			for (const_iterator pointIter = begin(), last = end(); pointIter != last; ++pointIter) {
-				real_t value = real_t(0);
-				vec_t position = pointIter->value;
-
-				Iter it = inFirst;
-				for (const Knot& knot : pointIter->knots) {
-					assert(it != inLast);
-					
-					// The domain scaling occurs only along this particular knots dimension.
-					real_t tmp = (knot.position - *it);
-					tmp = tmp * tmp;
-					value += knot.domain * tmp;
-					
-					tmp =  real_t(1) - real_t(1) / (tmp * tmp + real_t(1));
+			vec_t result(0);
+			CutoffStats local;
 
-					position += knot.tangent * tmp;
+			auto visit = [&](size_t p) {
+				++local.visited;
 
-					++it;
+				// Partial distance, bail out early
+				const size_t row = p * m;
+				real_t dist = real_t(0);
+				for (size_t k = 0; k < m && dist <= cutoff; ++k) {
+					real_t tmp = knotPositions[row + k] - input[k];
+					dist += knotDomains[row + k] * tmp * tmp;
+				}
+				if (dist > cutoff) {
+					return;
 				}
 
-				value = real_t(1) / (real_t(0.00001) + value);
+				vec_t position = values[p];
+				real_t value = sortedPointWeight(sortedPointKnots(knotPositions.data() + row, knotDomains.data() + row, knotTangents.data() + row, m, input, position));
 
+				++local.included;
+				local.includedWeight += value;
 				result += position * value;
-				sum += value;
+			};
+
+			// Pick the input with the fewest points inside the cutoff
+			const real_t* bestFirst = nullptr;
+			const real_t* bestLast = nullptr;
+			size_t bestInput = 0;
+			if (hasIndex() && count != 0) {
+				for (size_t k = 0; k < m; ++k) {
+					if (!(minDomains[k] > real_t(0))) {
+						continue;
+					}
+
+					real_t half = std::sqrt(cutoff / minDomains[k]);
+					const real_t* column = sortedPositions.data() + k * count;
+					const real_t* first = std::lower_bound(column, column + count, input[k] - half);
+					const real_t* last = std::upper_bound(first, column + count, input[k] + half);
+
+					if (bestFirst == nullptr || (last - first) < (bestLast - bestFirst)) {
+						bestFirst = first;
+						bestLast = last;
+						bestInput = k;
+					}
+				}
 			}
 
-			if (sum >= real_t(1E-5)) {
-				result /= sum;
+			if (bestFirst != nullptr) {
+				const real_t* column = sortedPositions.data() + bestInput * count;
+				const std::uint32_t* order = sortedPoints.data() + bestInput * count;
+				for (const real_t* it = bestFirst; it != bestLast; ++it) {
+					visit(order[it - column]);
+				}
+			}
+			else {
+				for (size_t p = 0; p < count; ++p) {
+					visit(p);
+				}
+			}
+
+			local.droppedWeight = static_cast<real_t>(count - local.included) * sortedPointWeight(cutoff);
+
+			if (local.includedWeight >= real_t(1E-5)) {
+				result /= local.includedWeight;
+			}
+			if (stats) {
+				*stats = local;
 			}
-			
 			return result;
 		}
+
+		/*
+		Stateful evaluation for when only one input changes at a time, like a single slider being dragged.
+		The per knot distance terms and tangent offsets are cached, so changing one input only updates that input's
+		contribution to each point, O(numPoints()) instead of O(numPoints() * numInputs()).
+		The incremental updates slowly accumulate rounding error, so everything is recomputed every 'recomputeInterval' updates.
+
+		The evaluator refers to the cloud, which must outlive it. Call reset after editing the cloud.
+		*/
+		class Evaluator {
+		public:
+			Evaluator(const SortedPointCloud& _cloud, std::size_t _recomputeInterval = 256)
+				: cloud(&_cloud)
+				, recomputeInterval(_recomputeInterval)
+				, updates(0)
+				, result(0)
+			{}
+
+			// Evaluate all the inputs from scratch, 'input' has numInputs() values.
+			vec_t reset(const real_t* input) {
+				inputs.assign(input, input + static_cast<size_t>(cloud->inputs));
+				return recompute();
+			}
+
+			// Change a single input and return the new result
+			vec_t setInput(index_t input, real_t value) {
+				assert(input >= 0 && input < cloud->numInputs());
+				assert(inputs.size() == static_cast<size_t>(cloud->numInputs()) && distances.size() == cloud->values.size());
+
+				if (++updates >= recomputeInterval) {
+					inputs[input] = value;
+					return recompute();
+				}
+
+				const size_t count = distances.size();
+				const size_t m = inputs.size();
+				inputs[input] = value;
+
+				for (size_t p = 0; p < count; ++p) {
+					const size_t i = p * m + static_cast<size_t>(input);
+
+					real_t term;
+					vec_t offset;
+					knotTerms(i, value, term, offset);
+
+					distances[p] += term - terms[i];
+					positions[p] += offset - offsets[i];
+					terms[i] = term;
+					offsets[i] = offset;
+				}
+				return blend();
+			}
+
+			// The result of the last update
+			const vec_t& value() const {
+				return result;
+			}
+			const std::vector<real_t>& getInputs() const {
+				return inputs;
+			}
+		private:
+			const SortedPointCloud* cloud;
+			std::size_t recomputeInterval, updates;
+
+			std::vector<real_t> inputs;
+			// Per knot, the domain scaled squared distance and the tangent offset
+			std::vector<real_t> terms;
+			std::vector<vec_t> offsets;
+			// Per point, the sums of the above
+			std::vector<real_t> distances;
+			std::vector<vec_t> positions;
+
+			vec_t result;
+
+			// Recompute every cached term from the current inputs
+			vec_t recompute() {
+				const size_t count = cloud->values.size();
+				const size_t m = inputs.size();
+
+				terms.resize(count * m);
+				offsets.resize(count * m);
+				distances.resize(count);
+				positions.resize(count);
+
+				for (size_t p = 0; p < count; ++p) {
+					const size_t row = p * m;
+					real_t dist = real_t(0);
+					vec_t position = cloud->values[p];
+					for (size_t k = 0; k < m; ++k) {
+						knotTerms(row + k, inputs[k], terms[row + k], offsets[row + k]);
+						dist += terms[row + k];
+						position += offsets[row + k];
+					}
+					distances[p] = dist;
+					positions[p] = position;
+				}
+
+				updates = 0;
+				return blend();
+			}
+
+			void knotTerms(size_t knot, real_t input, real_t& term, vec_t& offset) const {
+				real_t tmp = cloud->knotPositions[knot] - input;
+				tmp = tmp * tmp;
+				term = cloud->knotDomains[knot] * tmp;
+				offset = cloud->knotTangents[knot] * (real_t(1) - real_t(1) / (tmp * tmp + real_t(1)));
+			}
+
+			const vec_t& blend() {
+				result = vec_t(0);
+				real_t sum = real_t(0);
+				for (size_t p = 0; p < distances.size(); ++p) {
+					real_t value = intern::sortedPointWeight(distances[p]);
+					result += positions[p] * value;
+					sum += value;
+				}
+				if (sum >= real_t(1E-5)) {
+					result /= sum;
+				}
+				return result;
+			}
+		};
+
+		// The flat knot arrays, numPoints() rows of numInputs() values. The knot for (point, input) is at point * numInputs() + input.
+		const real_t* knotPositionData() const {
+			return knotPositions.data();
+		}
+		const real_t* knotDomainData() const {
+			return knotDomains.data();
+		}
+		const vec_t* knotTangentData() const {
+			return knotTangents.data();
+		}
+		// The point values, one per point.
+		const vec_t* pointData() const {
+			return values.data();
+		}
+	private:
+		template<bool> friend class BasicPoint;
+
+		index_t inputs;
+		// The interpolation points.
+		std::vector<vec_t> values;
+
+		// The knot fields, row major by point.
+		std::vector<real_t> knotPositions;
+		std::vector<real_t> knotDomains;
+		std::vector<vec_t> knotTangents;
+
+		// Per input index, built by buildIndex.
+		// For input k, sortedPoints[k * numPoints() + i] is the point with the i-th smallest knot position, which is sortedPositions[k * numPoints() + i].
+		std::vector<std::uint32_t> sortedPoints;
+		std::vector<real_t> sortedPositions;
+		// Smallest knot domain along each input
+		std::vector<real_t> minDomains;
+		bool indexDirty;
+
+		KnotRef knotAt(index_t point, index_t input) {
+			size_t i = static_cast<size_t>(point * inputs + input);
+			return KnotRef{ knotPositions[i], knotDomains[i], knotTangents[i] };
+		}
+		ConstKnotRef knotAt(index_t point, index_t input) const {
+			size_t i = static_cast<size_t>(point * inputs + input);
+			return ConstKnotRef{ knotPositions[i], knotDomains[i], knotTangents[i] };
+		}
+
+		void insertPoint(index_t index, vec_t value) {
+			assert(index >= 0 && index <= numPoints());
+
+			const size_t row = static_cast<size_t>(index * inputs);
+			indexDirty = true;
+			values.insert(values.begin() + index, value);
+			knotPositions.insert(knotPositions.begin() + row, inputs, Knot{}.position);
+			knotDomains.insert(knotDomains.begin() + row, inputs, Knot{}.domain);
+			knotTangents.insert(knotTangents.begin() + row, inputs, Knot{}.tangent);
+		}
+		void erasePoint(index_t index) {
+			assert(index >= 0 && index < numPoints());
+
+			const size_t first = static_cast<size_t>(index * inputs), last = first + static_cast<size_t>(inputs);
+			indexDirty = true;
+			values.erase(values.begin() + index);
+			knotPositions.erase(knotPositions.begin() + first, knotPositions.begin() + last);
+			knotDomains.erase(knotDomains.begin() + first, knotDomains.begin() + last);
+			knotTangents.erase(knotTangents.begin() + first, knotTangents.begin() + last);
+		}
+
+		vec_t evalImpl(const real_t* input) const {
+			return intern::sortedPointCloudEval(values.data(), knotPositions.data(), knotDomains.data(), knotTangents.data(), values.size(), static_cast<size_t>(inputs), input);
+		}
+
+		template<typename Iter>
+		vec_t evalCopy(Iter first, Iter last) const {
+			// The kernel needs the inputs contiguous
+			std::array<real_t, intern::SortedKnotBlock> local;
+			std::vector<real_t> heap;
+
+			real_t* input = local.data();
+			if (static_cast<size_t>(inputs) > local.size()) {
+				heap.resize(inputs);
+				input = heap.data();
+			}
+
+			for (index_t i = 0; i < inputs; ++i) {
+				assert(first != last);
+				input[i] = static_cast<real_t>(*first);
+				++first;
+			}
+			return evalImpl(input);
+		}
 	public:
 		vec_t eval(real_t * begin, real_t * end) const {
-			return evalImpl(begin, end);
+			assert((end - begin) >= inputs);
+			return evalImpl(begin);
+		}
+		vec_t eval(const real_t* begin, const real_t* end) const {
+			assert((end - begin) >= inputs);
+			return evalImpl(begin);
 		}
 
 		template<typename Iter>
 		vec_t eval(Iter begin, Iter end) const {
-			static_assert(std::is_convertible<typename Iter::value_type, real_t>::value, "The iterator passed into ez::PointCloud does not have convertible value type.");
-			return evalImpl(begin, end);
+			static_assert(std::is_convertible<typename std::iterator_traits<Iter>::value_type, real_t>::value, "The iterator passed into ez::PointCloud does not have convertible value type.");
+			return evalCopy(begin, end);
+		}
+
+		/*
+		Evaluate 'count' input vectors, input vector i starts at inputs + i * stride and has numInputs() values.
+		The queries are evaluated in groups against blocks of points, so the knots are read from memory once per group instead of once per query.
+		With a parallel policy the groups are spread across threads.
+		*/
+		template<typename Policy>
+		void evalBatch(const real_t* input, size_t count, size_t stride, vec_t* output, const Policy& policy) const {
+			static_assert(ez::is_execution_policy_v<Policy>, "ez::SortedPointCloud::evalBatch requires an execution policy!");
+			assert(stride >= static_cast<size_t>(inputs) || count <= 1);
+
+			using namespace ez::intern;
+
+			const size_t numPoints = values.size();
+			const size_t m = static_cast<size_t>(inputs);
+			const size_t bytesPerPoint = std::max<size_t>(m * (2 * sizeof(real_t) + sizeof(vec_t)), 1);
+			const size_t pointBlock = std::max<size_t>(SortedPointBlockBytes / bytesPerPoint, 1);
+
+			intern::parallelFor(policy, count, [&](size_t first, size_t last) {
+				std::array<vec_t, SortedQueryBlock> results;
+				std::array<real_t, SortedQueryBlock> sums;
+
+				for (size_t group = first; group < last; group += SortedQueryBlock) {
+					const size_t n = std::min(SortedQueryBlock, last - group);
+					std::fill_n(results.begin(), n, vec_t(0));
+					std::fill_n(sums.begin(), n, real_t(0));
+
+					for (size_t block = 0; block < numPoints; block += pointBlock) {
+						const size_t blockEnd = std::min(block + pointBlock, numPoints);
+
+						for (size_t q = 0; q < n; ++q) {
+							const real_t* in = input + (group + q) * stride;
+							for (size_t p = block; p < blockEnd; ++p) {
+								const size_t row = p * m;
+								vec_t position = values[p];
+								real_t value = sortedPointWeight(sortedPointKnots(knotPositions.data() + row, knotDomains.data() + row, knotTangents.data() + row, m, in, position));
+
+								results[q] += position * value;
+								sums[q] += value;
+							}
+						}
+					}
+
+					for (size_t q = 0; q < n; ++q) {
+						if (sums[q] >= real_t(1E-5)) {
+							results[q] /= sums[q];
+						}
+						output[group + q] = results[q];
+					}
+				}
+			});
+		}
+		void evalBatch(const real_t* input, size_t count, size_t stride, vec_t* output) const {
+			evalBatch(input, count, stride, output, execution::seq);
 		}
 	};
-};
\ No newline at end of file
+};
@@ -0,0 +1,492 @@
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <memory_resource>
+#include <cstring>
+#include <limits>
+#include <cmath>
+
+#include <ez/bezier/BPath.hpp>
+#include <ez/bezier/BPathSet.hpp>
+#include <ez/bezier/StaticBPath.hpp>
+#include <ez/bezier/BPathStore.hpp>
+#include <ez/bezier/CornerPath.hpp>
+#include <ez/bezier/Stroke.hpp>
+
+using Approx = Catch::Approx;
+
+namespace {
+	std::vector<glm::vec2> testPoints() {
+		return std::vector<glm::vec2>{{
+			glm::vec2{ 0, 0 },
+			glm::vec2{ 10, 5 },
+			glm::vec2{ 20, -5 },
+			glm::vec2{ 30, 10 },
+			glm::vec2{ 25, 20 },
+			glm::vec2{ 10, 15 }
+		}};
+	}
+
+	// Single open segment, for the stroke of a hand made cubic
+	struct SegmentPath {
+		using value_type = glm::vec2;
+		using real_t = float;
+
+		std::array<glm::vec2, 4> segment;
+
+		std::size_t numSegments() const {
+			return 1;
+		}
+		const std::array<glm::vec2, 4>& segmentAt(std::size_t) const {
+			return segment;
+		}
+		bool isOpen() const {
+			return true;
+		}
+	};
+}
+
+TEST_CASE("BPath segments are continuous") {
+	std::vector<glm::vec2> points = testPoints();
+
+	for (bool open : { true, false }) {
+		ez::BPath<glm::vec2> path{ points.begin(), points.end(), open };
+
+		INFO("open == " << open);
+		REQUIRE(path.numSegments() == (open ? points.size() - 2 : points.size()));
+
+		for (std::size_t i = 1; i < path.numSegments(); ++i) {
+			auto prev = path.segmentAt(i - 1);
+			auto next = path.segmentAt(i);
+
+			REQUIRE(prev[3].x == Approx(next[0].x));
+			REQUIRE(prev[3].y == Approx(next[0].y));
+		}
+	}
+}
+
+TEST_CASE("BPath with polymorphic allocator") {
+	std::vector<glm::vec2> points = testPoints();
+
+	std::array<std::byte, 1024> buffer;
+	std::pmr::monotonic_buffer_resource arena{ buffer.data(), buffer.size(), std::pmr::null_memory_resource() };
+
+	ez::pmr::BPath<glm::vec2> path{ &arena };
+	path.assign(points.begin(), points.end());
+
+	REQUIRE(path.get_allocator().resource() == &arena);
+	REQUIRE(path.size() == points.size());
+
+	ez::BPath<glm::vec2> compare{ points.begin(), points.end() };
+	for (std::size_t i = 0; i < path.numSegments(); ++i) {
+		auto lh = path.segmentAt(i);
+		auto rh = compare.segmentAt(i);
+		for (int k = 0; k < 4; ++k) {
+			REQUIRE(lh[k].x == Approx(rh[k].x));
+			REQUIRE(lh[k].y == Approx(rh[k].y));
+		}
+	}
+
+	// Copying into the same arena keeps the resource
+	ez::pmr::BPath<glm::vec2> copy{ path, &arena };
+	REQUIRE(copy.get_allocator().resource() == &arena);
+	REQUIRE(copy.size() == path.size());
+
+	// Swapping requires equal allocators, both paths share the arena here
+	ez::pmr::BPath<glm::vec2> empty{ &arena };
+	empty.swap(copy);
+	REQUIRE(empty.size() == path.size());
+	REQUIRE(copy.size() == 0);
+}
+
+TEST_CASE("BPathSet matches individual BPaths") {
+	std::vector<glm::vec2> points = testPoints();
+
+	std::vector<ez::BPath<glm::vec2>> paths;
+	paths.emplace_back(points.begin(), points.end(), true);
+	paths.emplace_back(points.begin() + 1, points.end(), false);
+	paths.emplace_back(points.begin(), points.begin() + 2, true);
+	paths.emplace_back(points.rbegin(), points.rend(), false);
+
+	ez::BPathSet<glm::vec2> set;
+	for (const auto& path : paths) {
+		set.addPath(path);
+	}
+
+	REQUIRE(set.numPaths() == paths.size());
+
+	for (std::size_t p = 0; p < paths.size(); ++p) {
+		const auto& path = paths[p];
+
+		INFO("path == " << p);
+		REQUIRE(set.numPoints(p) == path.numPoints());
+		REQUIRE(set.isOpen(p) == path.isOpen());
+		REQUIRE(set.numSegments(p) == path.numSegments());
+		REQUIRE(set.length(p) == Approx(path.length()));
+
+		for (std::size_t i = 0; i < path.numSegments(); ++i) {
+			auto lh = set.segmentAt(p, i);
+			auto rh = path.segmentAt(i);
+			for (int k = 0; k < 4; ++k) {
+				REQUIRE(lh[k].x == Approx(rh[k].x));
+				REQUIRE(lh[k].y == Approx(rh[k].y));
+			}
+		}
+
+		if (path.numSegments() != 0) {
+			for (float t : { 0.f, 0.3f, 0.7f, 1.f }) {
+				glm::vec2 lh = set.evalAt(p, t);
+				glm::vec2 rh = path.evalAt(t);
+				REQUIRE(lh.x == Approx(rh.x));
+				REQUIRE(lh.y == Approx(rh.y));
+			}
+		}
+	}
+
+	set.pop_back();
+	REQUIRE(set.numPaths() == paths.size() - 1);
+	REQUIRE(set.totalPoints() == 6 + 5 + 2);
+}
+
+TEST_CASE("BPathSet can be reused after a move") {
+	std::vector<glm::vec2> points = testPoints();
+
+	ez::BPathSet<glm::vec2> set;
+	set.addPath(points.begin(), points.end());
+
+	for (bool assign : { false, true }) {
+		const std::size_t count = set.numPoints(0);
+		ez::BPathSet<glm::vec2> moved;
+		if (assign) {
+			moved = std::move(set);
+		}
+		else {
+			moved = ez::BPathSet<glm::vec2>{ std::move(set) };
+		}
+		REQUIRE(moved.numPaths() == 1);
+		REQUIRE(moved.numPoints(0) == count);
+
+		INFO("assign == " << assign);
+		REQUIRE(set.empty());
+		REQUIRE(set.offsetBuffer().size() == 1);
+		set.addPath(points.begin(), points.begin() + 3);
+		REQUIRE(set.numPaths() == 1);
+		REQUIRE(set.numPoints(0) == 3);
+		REQUIRE(set.pathData(0)[2] == points[2]);
+	}
+}
+
+TEST_CASE("BPath toSegments matches segmentAt") {
+	std::vector<glm::vec2> points = testPoints();
+
+	for (std::size_t count = 4; count <= points.size(); ++count) {
+		for (bool open : { true, false }) {
+			ez::BPath<glm::vec2> path{ points.begin(), points.begin() + count, open };
+
+			std::vector<ez::BPath<glm::vec2>::Segment> segments(path.numSegments());
+			REQUIRE(path.toSegments(segments.data()) == path.numSegments());
+
+			std::vector<glm::vec2> p0, p1, p2, p3;
+			path.toSegmentsSoA(std::back_inserter(p0), std::back_inserter(p1), std::back_inserter(p2), std::back_inserter(p3));
+			REQUIRE(p3.size() == path.numSegments());
+
+			INFO("count == " << count << ", open == " << open);
+			for (std::size_t i = 0; i < path.numSegments(); ++i) {
+				auto compare = path.segmentAt(i);
+				for (int k = 0; k < 4; ++k) {
+					REQUIRE(segments[i][k].x == Approx(compare[k].x));
+					REQUIRE(segments[i][k].y == Approx(compare[k].y));
+				}
+				REQUIRE(p0[i].x == Approx(compare[0].x));
+				REQUIRE(p1[i].y == Approx(compare[1].y));
+				REQUIRE(p2[i].x == Approx(compare[2].x));
+				REQUIRE(p3[i].y == Approx(compare[3].y));
+			}
+		}
+	}
+}
+
+TEST_CASE("StaticBPath matches BPath") {
+	static constexpr ez::StaticBPath<glm::vec2, 5> rail{ {{
+		glm::vec2{ 0, 0 },
+		glm::vec2{ 1, 2 },
+		glm::vec2{ 3, 3 },
+		glm::vec2{ 4, 1 },
+		glm::vec2{ 6, 0 }
+	}} };
+
+	// Evaluation can happen at compile time
+	static constexpr glm::vec2 mid = rail.evalAt(0.5f);
+	static_assert(rail.numSegments() == 3);
+
+	ez::BPath<glm::vec2> path = rail.toBPath();
+	glm::vec2 compare = path.evalAt(0.5f);
+	REQUIRE(mid.x == Approx(compare.x));
+	REQUIRE(mid.y == Approx(compare.y));
+
+	for (std::size_t i = 0; i < rail.numSegments(); ++i) {
+		auto lh = rail.segmentAt(i);
+		auto rh = path.segmentAt(i);
+		for (int k = 0; k < 4; ++k) {
+			REQUIRE(lh[k].x == Approx(rh[k].x));
+			REQUIRE(lh[k].y == Approx(rh[k].y));
+		}
+	}
+	REQUIRE(rail.length() == Approx(path.length()));
+}
+
+TEST_CASE("BPathSetView evaluates a written store") {
+	std::vector<glm::vec2> points = testPoints();
+
+	ez::BPathSet<glm::vec2> set;
+	set.addPath(points.begin(), points.end(), true);
+	set.addPath(points.begin() + 1, points.end(), false);
+	set.addPath(points.begin(), points.begin() + 3, true);
+
+	std::vector<char> bytes;
+	std::size_t written = ez::writeBPathStore(set, std::back_inserter(bytes));
+	REQUIRE(written == bytes.size());
+	REQUIRE(written == ez::bpathStoreSize(set));
+
+	// The view requires an 8 byte aligned buffer, like a mapped file.
+	std::vector<std::uint64_t> aligned((bytes.size() + 7) / 8);
+	std::memcpy(aligned.data(), bytes.data(), bytes.size());
+
+	ez::BPathSetView<glm::vec2> view;
+	REQUIRE(view.assign(aligned.data(), bytes.size()));
+	REQUIRE(view.numPaths() == set.numPaths());
+
+	for (std::size_t p = 0; p < set.numPaths(); ++p) {
+		INFO("path == " << p);
+		REQUIRE(view.numPoints(p) == set.numPoints(p));
+		REQUIRE(view.isOpen(p) == set.isOpen(p));
+		REQUIRE(view.length(p) == Approx(set.length(p)));
+		for (std::size_t i = 0; i < set.numPoints(p); ++i) {
+			REQUIRE(view.pathData(p)[i] == set.pointAt(p, i));
+		}
+	}
+
+	// Wrong vector type, truncated data
+	ez::BPathSetView<glm::vec3> wrongType;
+	REQUIRE_FALSE(wrongType.assign(aligned.data(), bytes.size()));
+	REQUIRE_FALSE(view.assign(aligned.data(), bytes.size() - 1));
+	REQUIRE(view.empty());
+}
+
+namespace {
+	// A single corner adds one segment
+	std::size_t cornerSegmentCount(std::size_t count, bool open) {
+		return (open ? count - 2 : count) + 1;
+	}
+}
+
+TEST_CASE("CornerPath") {
+	using Path = ez::CornerPath<glm::vec2>;
+	std::vector<glm::vec2> points = testPoints();
+
+	auto requireSame = [](const Path::Segment& lh, const Path::Segment& rh) {
+		for (int k = 0; k < 4; ++k) {
+			REQUIRE(lh[k].x == Approx(rh[k].x).margin(1e-5));
+			REQUIRE(lh[k].y == Approx(rh[k].y).margin(1e-5));
+		}
+	};
+
+	SECTION("Without corners it matches BPath") {
+		for (bool open : { true, false }) {
+			Path path;
+			path.setOpen(open);
+			for (const glm::vec2& point : points) {
+				path.append(point);
+			}
+			ez::BPath<glm::vec2> compare{ points.begin(), points.end(), open };
+
+			INFO("open == " << open);
+			REQUIRE(path.numSegments() == compare.numSegments());
+			for (std::size_t i = 0; i < path.numSegments(); ++i) {
+				requireSame(path.segmentAt(i), compare.segmentAt(i));
+			}
+		}
+	}
+
+	SECTION("Corners are interpolated") {
+		for (bool open : { true, false }) {
+			Path path;
+			path.setOpen(open);
+			for (const glm::vec2& point : points) {
+				path.append(point);
+			}
+			path.setCorner(2, true);
+
+			INFO("open == " << open);
+			REQUIRE(path.numSegments() == cornerSegmentCount(points.size(), open));
+
+			bool found = false;
+			for (std::size_t i = 0; i < path.numSegments(); ++i) {
+				found = found || (path.segmentAt(i)[3] == points[2]);
+			}
+			REQUIRE(found);
+		}
+	}
+
+	SECTION("Moving a control matches a full rebuild") {
+		for (bool open : { true, false }) {
+			std::vector<Path::Control> controls;
+			for (const glm::vec2& point : points) {
+				controls.push_back(Path::Control{ false, point });
+			}
+			controls[1].corner = true;
+			controls[4].corner = true;
+
+			Path path{ controls.begin(), controls.end(), open };
+			for (std::size_t i = 0; i < controls.size(); ++i) {
+				controls[i].position += glm::vec2{ 3.f, -2.f };
+				path.setPosition(i, controls[i].position);
+
+				Path compare{ controls.begin(), controls.end(), open };
+
+				INFO("open == " << open << ", moved == " << i);
+				REQUIRE(path.numSegments() == compare.numSegments());
+				for (std::size_t s = 0; s < path.numSegments(); ++s) {
+					requireSame(path.segmentAt(s), compare.segmentAt(s));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Stroke outlines") {
+	using ez::bezier::JoinStyle;
+	using ez::bezier::CapStyle;
+
+	auto requireClosed = [](const std::vector<glm::vec2>& out, std::ptrdiff_t first, std::ptrdiff_t last) {
+		REQUIRE(last > first);
+		REQUIRE((last - first - 1) % 3 == 0);
+		REQUIRE(out[first].x == Approx(out[last - 1].x).margin(1e-3));
+		REQUIRE(out[first].y == Approx(out[last - 1].y).margin(1e-3));
+	};
+
+	SECTION("Caps of a straight path") {
+		std::vector<glm::vec2> points;
+		for (int i = 0; i <= 10; ++i) {
+			points.push_back(glm::vec2{ float(i * 10), 0.f });
+		}
+		ez::BPath<glm::vec2> path{ points.begin(), points.end(), true };
+
+		for (CapStyle cap : { CapStyle::Butt, CapStyle::Square, CapStyle::Round }) {
+			std::vector<glm::vec2> out;
+			auto count = ez::bezier::stroke(path, 10.f, JoinStyle::Miter, cap, std::back_inserter(out));
+
+			INFO("cap == " << int(cap));
+			REQUIRE(count.count == std::ptrdiff_t(out.size()));
+			REQUIRE(count.firstContour == count.count);
+			requireClosed(out, 0, count.count);
+
+			float extend = cap == CapStyle::Butt ? 0.f : 5.f;
+			glm::vec2 lo{ std::numeric_limits<float>::max() }, hi{ std::numeric_limits<float>::lowest() };
+			// Only the points on the outline, the controls of a round cap stick out a little
+			for (std::size_t i = 0; i < out.size(); i += 3) {
+				lo = glm::min(lo, out[i]);
+				hi = glm::max(hi, out[i]);
+			}
+			// The path starts and ends half way to the second and second last points
+			REQUIRE(lo.x == Approx(5.f - extend).margin(1e-3));
+			REQUIRE(hi.x == Approx(95.f + extend).margin(1e-3));
+			REQUIRE(lo.y == Approx(-5.f).margin(1e-3));
+			REQUIRE(hi.y == Approx(5.f).margin(1e-3));
+		}
+	}
+
+	SECTION("Joins at a corner") {
+		// Right turn at (20, 0), the outer side is on the left
+		using Path = ez::CornerPath<glm::vec2>;
+		std::vector<Path::Control> controls{ {
+			Path::Control{ false, glm::vec2{ 0, 0 } },
+			Path::Control{ false, glm::vec2{ 10, 0 } },
+			Path::Control{ true, glm::vec2{ 20, 0 } },
+			Path::Control{ false, glm::vec2{ 20, -10 } },
+			Path::Control{ false, glm::vec2{ 20, -20 } }
+		} };
+		Path path{ controls.begin(), controls.end(), true };
+
+		// Distance to the closest sample of the outline, at the ends and middle of each cubic
+		auto nearest = [](const std::vector<glm::vec2>& out, glm::vec2 target) {
+			float best = glm::length(out[0] - target);
+			for (std::size_t i = 0; i + 3 < out.size(); i += 3) {
+				glm::vec2 mid = ez::bezier::interpolate(out[i], out[i + 1], out[i + 2], out[i + 3], 0.5f);
+				best = std::min(best, glm::length(mid - target));
+				best = std::min(best, glm::length(out[i + 3] - target));
+			}
+			return best;
+		};
+
+		std::vector<glm::vec2> miter, bevel, round;
+		auto miterCount = ez::bezier::stroke(path, 4.f, JoinStyle::Miter, CapStyle::Butt, std::back_inserter(miter));
+		ez::bezier::stroke(path, 4.f, JoinStyle::Bevel, CapStyle::Butt, std::back_inserter(bevel));
+		ez::bezier::stroke(path, 4.f, JoinStyle::Round, CapStyle::Butt, std::back_inserter(round));
+		requireClosed(miter, 0, miterCount.count);
+
+		const glm::vec2 tip{ 22.f, 2.f };
+		REQUIRE(nearest(miter, tip) < 1e-3f);
+		REQUIRE(nearest(bevel, tip) > 1.f);
+		REQUIRE(nearest(round, tip) > 0.5f);
+		// The middle of the round join is on the circle around the corner
+		REQUIRE(nearest(round, glm::vec2{ 20.f, 0.f } + glm::normalize(glm::vec2{ 1.f, 1.f }) * 2.f) < 1e-2f);
+		for (const glm::vec2& point : round) {
+			REQUIRE_FALSE(std::isnan(point.x));
+		}
+
+		// Past the miter limit the join is beveled
+		std::vector<glm::vec2> limited;
+		ez::bezier::stroke(path, 4.f, JoinStyle::Miter, CapStyle::Butt, std::back_inserter(limited), 1.2f);
+		REQUIRE(nearest(limited, tip) > 1.f);
+	}
+
+	SECTION("Pointer output matches inserter output") {
+		std::vector<glm::vec2> points = testPoints();
+		ez::BPath<glm::vec2> path{ points.begin(), points.end(), false };
+
+		std::vector<glm::vec2> inserted;
+		auto count = ez::bezier::stroke(path, 2.f, JoinStyle::Miter, CapStyle::Butt, std::back_inserter(inserted));
+
+		std::vector<glm::vec2> buffer(inserted.size());
+		auto pointerCount = ez::bezier::stroke(path, 2.f, JoinStyle::Miter, CapStyle::Butt, buffer.data());
+		REQUIRE(pointerCount.count == count.count);
+		REQUIRE(pointerCount.firstContour == count.firstContour);
+		for (std::size_t i = 0; i < buffer.size(); ++i) {
+			REQUIRE(buffer[i].x == inserted[i].x);
+			REQUIRE(buffer[i].y == inserted[i].y);
+		}
+	}
+
+	SECTION("Both controls on one end") {
+		for (bool atStart : { true, false }) {
+			glm::vec2 p{ 0, 0 }, q{ 30, 0 };
+			SegmentPath path{ atStart ? std::array<glm::vec2, 4>{ { p, p, p, q } } : std::array<glm::vec2, 4>{ { p, q, q, q } } };
+
+			std::vector<glm::vec2> out;
+			auto count = ez::bezier::stroke(path, 4.f, JoinStyle::Miter, CapStyle::Butt, std::back_inserter(out));
+
+			INFO("atStart == " << atStart);
+			requireClosed(out, 0, count.count);
+			for (const glm::vec2& point : out) {
+				REQUIRE_FALSE(std::isnan(point.x));
+				REQUIRE_FALSE(std::isnan(point.y));
+				REQUIRE(std::abs(point.y) <= 2.01f);
+			}
+		}
+	}
+
+	SECTION("Closed paths have two contours") {
+		std::vector<glm::vec2> points = testPoints();
+		ez::BPath<glm::vec2> path{ points.begin(), points.end(), false };
+
+		std::vector<glm::vec2> out;
+		auto count = ez::bezier::stroke(path, 2.f, JoinStyle::Round, CapStyle::Round, std::back_inserter(out));
+		REQUIRE(count.firstContour > 0);
+		REQUIRE(count.count == std::ptrdiff_t(out.size()));
+		requireClosed(out, 0, count.firstContour);
+		requireClosed(out, count.firstContour, count.count);
+	}
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <random>
+
+#include <glm/geometric.hpp>
+
+#include <ez/bezier/Bezier.hpp>
+#include <ez/bezier/OffsetBatch.hpp>
+
+namespace bezier = ez::bezier;
+
+TEST_CASE("Cubic pixelOffset stays within the threshold") {
+	// The curve from the gui offset test, and one where the middle turns much tighter than the ends
+	std::vector<std::array<glm::vec2, 4>> curves{ {
+		{ { glm::vec2{ 100, 500 }, glm::vec2{ 100, 100 }, glm::vec2{ 700, 100 }, glm::vec2{ 700, 500 } } },
+		{ { glm::vec2{ 100, 500 }, glm::vec2{ 400, 100 }, glm::vec2{ 410, 100 }, glm::vec2{ 700, 500 } } }
+	} };
+
+	for (const auto& curve : curves) {
+		for (float delta : { 8.f, -32.f }) {
+			std::vector<glm::vec2> out;
+			std::ptrdiff_t count = bezier::pixelOffset(curve[0], curve[1], curve[2], curve[3], delta, std::back_inserter(out));
+			REQUIRE(count == std::ptrdiff_t(out.size()));
+			REQUIRE((out.size() - 1) % 3 == 0);
+
+			// Each point of the offset should be 'delta' away from the closest point on the curve
+			std::vector<glm::vec2> dense(1025);
+			for (std::size_t i = 0; i < dense.size(); ++i) {
+				dense[i] = bezier::interpolate(curve[0], curve[1], curve[2], curve[3], float(i) / float(dense.size() - 1));
+			}
+			for (std::size_t i = 0; i + 3 < out.size(); i += 3) {
+				for (int k = 1; k < 8; ++k) {
+					glm::vec2 p = bezier::interpolate(out[i], out[i + 1], out[i + 2], out[i + 3], float(k) / 8.f);
+					float best = glm::length(p - dense[0]);
+					for (const glm::vec2& d : dense) {
+						best = std::min(best, glm::length(p - d));
+					}
+					INFO("delta == " << delta << ", segment " << i / 3);
+					REQUIRE(std::abs(best - std::abs(delta)) < 0.5f);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("pixelOffsetBatch matches pixelOffset") {
+	std::mt19937 gen{ 11 };
+	std::uniform_real_distribution<float> dist{ 0.f, 800.f };
+
+	std::vector<std::array<glm::vec2, 4>> curves(300);
+	for (auto& curve : curves) {
+		// Gentle curves, so none of them have cusps
+		glm::vec2 start{ dist(gen), dist(gen) };
+		glm::vec2 end = start + glm::vec2{ 300.f, 0.f };
+		curve = { { start, start + glm::vec2{ 100.f, dist(gen) * 0.2f }, end - glm::vec2{ 100.f, dist(gen) * 0.2f }, end } };
+	}
+
+	std::vector<glm::vec2> expected;
+	std::vector<std::size_t> expectedOffsets{ 0 };
+	for (const auto& curve : curves) {
+		bezier::pixelOffset(curve[0], curve[1], curve[2], curve[3], 12.f, std::back_inserter(expected));
+		expectedOffsets.push_back(expected.size());
+	}
+
+	std::vector<glm::vec2> serial, parallel;
+	std::vector<std::size_t> serialOffsets, parallelOffsets;
+	bezier::pixelOffsetBatch(curves.data(), curves.size(), 12.f, serial, serialOffsets);
+
+	ez::execution::parallel_policy policy;
+	policy.threads = 4;
+	policy.grain = 16;
+	bezier::pixelOffsetBatch(curves.data(), curves.size(), 12.f, parallel, parallelOffsets, policy);
+
+	REQUIRE(serialOffsets == expectedOffsets);
+	REQUIRE(parallelOffsets == expectedOffsets);
+	REQUIRE(serial == expected);
+	REQUIRE(parallel == expected);
+}
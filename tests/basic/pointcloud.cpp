@@ -0,0 +1,823 @@
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include <ez/interpolate/PointCloud.hpp>
+#include <ez/interpolate/PackedPointCloud.hpp>
+#include <ez/interpolate/QuantizedPointCloud.hpp>
+#include <ez/interpolate/RBFCloud.hpp>
+#include <ez/interpolate/intern/SortedPointCloud.hpp>
+#include <ez/interpolate/CloudStore.hpp>
+
+using Approx = Catch::Approx;
+
+namespace {
+	using Cloud = ez::PointCloud<float, 2, 3>;
+
+	Cloud makeCloud(std::size_t count) {
+		std::mt19937 gen{ 1234 };
+		std::uniform_real_distribution<float> dist{ -10.f, 10.f };
+
+		Cloud cloud;
+		for (std::size_t i = 0; i < count; ++i) {
+			cloud.push_back(glm::vec2{ dist(gen), dist(gen) }, glm::vec3{ dist(gen), dist(gen), dist(gen) });
+			cloud[i].domain = glm::vec2{ 1.f + 0.1f * float(i % 3), 1.f };
+			cloud[i].tangent[0] = glm::vec3{ 0.1f, 0.f, 0.f };
+		}
+		return cloud;
+	}
+
+	void requireEqual(const glm::vec3& lh, const glm::vec3& rh) {
+		REQUIRE(lh.x == Approx(rh.x).margin(1e-4));
+		REQUIRE(lh.y == Approx(rh.y).margin(1e-4));
+		REQUIRE(lh.z == Approx(rh.z).margin(1e-4));
+	}
+}
+
+TEST_CASE("PointCloud eval interpolates the points") {
+	Cloud cloud = makeCloud(20);
+
+	for (std::size_t i = 0; i < cloud.size(); ++i) {
+		requireEqual(cloud.eval(cloud[i].position), cloud[i].output);
+	}
+}
+
+TEST_CASE("PointCloud evalNearest") {
+	Cloud cloud = makeCloud(500);
+	std::vector<glm::vec2> queries{ {
+		glm::vec2{ 0, 0 },
+		glm::vec2{ 3.5, -2 },
+		glm::vec2{ -9, 9.5 },
+		glm::vec2{ 20, 0 }
+	} };
+
+	SECTION("Indexed search matches the brute force search") {
+		Cloud brute = cloud;
+		cloud.buildIndex();
+		REQUIRE(cloud.hasIndex());
+		REQUIRE_FALSE(brute.hasIndex());
+
+		for (const glm::vec2& query : queries) {
+			requireEqual(cloud.evalNearest(query, 8), brute.evalNearest(query, 8));
+			requireEqual(cloud.evalRadius(query, 3.f), brute.evalRadius(query, 3.f));
+		}
+	}
+
+	SECTION("All the points is the same as eval") {
+		Cloud small = makeCloud(10);
+		small.buildIndex();
+		for (const glm::vec2& query : queries) {
+			requireEqual(small.evalNearest(query, 10), small.eval(query));
+		}
+
+		// More points than MaxNeighbors
+		const Cloud& large = cloud;
+		REQUIRE(large.size() > Cloud::MaxNeighbors);
+		for (const glm::vec2& query : queries) {
+			requireEqual(large.evalNearest(query, large.size()), large.eval(query));
+		}
+	}
+
+	SECTION("Editing invalidates the index") {
+		cloud.buildIndex();
+		cloud[0].position = glm::vec2{ 100, 100 };
+		REQUIRE_FALSE(cloud.hasIndex());
+	}
+}
+
+TEST_CASE("PointCloud evalBatch") {
+	const Cloud cloud = makeCloud(200);
+
+	std::mt19937 gen{ 42 };
+	std::uniform_real_distribution<float> dist{ -12.f, 12.f };
+
+	std::vector<glm::vec2> inputs(1000);
+	for (glm::vec2& input : inputs) {
+		input = glm::vec2{ dist(gen), dist(gen) };
+	}
+
+	std::vector<glm::vec3> serial(inputs.size()), parallel(inputs.size());
+	cloud.evalBatch(inputs.data(), inputs.size(), serial.data());
+
+	ez::execution::parallel_policy policy;
+	policy.threads = 4;
+	policy.grain = 16;
+	cloud.evalBatch(inputs.data(), inputs.size(), parallel.data(), policy);
+
+	for (std::size_t i = 0; i < inputs.size(); ++i) {
+		REQUIRE(serial[i] == parallel[i]);
+		requireEqual(serial[i], cloud.eval(inputs[i]));
+	}
+}
+
+TEST_CASE("Parallel exceptions reach the caller") {
+	ez::execution::parallel_policy policy;
+	policy.threads = 4;
+	policy.grain = 1;
+
+	// Thrown on a worker and on the calling thread, every other block still runs
+	for (std::size_t throwing : { std::size_t(0), std::size_t(3) }) {
+		std::vector<int> visited(8, 0);
+		auto func = [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i) {
+				visited[i] = 1;
+			}
+			if (first == throwing * 2) {
+				throw std::runtime_error("block failed");
+			}
+		};
+
+		INFO("throwing == " << throwing);
+		REQUIRE_THROWS_AS(ez::intern::parallelFor(policy, visited.size(), func), std::runtime_error);
+		REQUIRE(std::count(visited.begin(), visited.end(), 1) == 8);
+	}
+}
+
+TEST_CASE("PackedPointCloud matches PointCloud") {
+	// Odd count, so the remainder of the kernel is used too
+	const Cloud cloud = makeCloud(101);
+	const ez::PackedPointCloud<float, 2, 3> packed{ cloud };
+
+	REQUIRE(packed.size() == cloud.size());
+
+	std::mt19937 gen{ 7 };
+	std::uniform_real_distribution<float> dist{ -12.f, 12.f };
+	for (int i = 0; i < 100; ++i) {
+		glm::vec2 input{ dist(gen), dist(gen) };
+		requireEqual(packed.eval(input), cloud.eval(input));
+	}
+	for (std::size_t i = 0; i < cloud.size(); ++i) {
+		requireEqual(packed.eval(cloud[i].position), cloud[i].output);
+	}
+
+	// Scalar input and output
+	ez::PointCloud<double, 1, 1> line;
+	line.push_back(0.0, 1.0);
+	line.push_back(1.0, 3.0);
+	line.push_back(2.0, -1.0);
+	ez::PackedPointCloud<double, 1, 1> packedLine{ line };
+	REQUIRE(packedLine.eval(0.5) == Approx(line.eval(0.5)));
+	REQUIRE(packedLine.eval(1.0) == Approx(3.0));
+}
+
+TEST_CASE("QuantizedPointCloud is close to PointCloud") {
+	const Cloud cloud = makeCloud(101);
+	const ez::QuantizedPointCloud<float, 2, 3> quantized{ cloud };
+
+	// Thirteen arrays per point, of which only the three outputs are full floats
+	REQUIRE(quantized.size() == cloud.size());
+	REQUIRE(quantized.memoryUsage() == cloud.size() * (10 * sizeof(std::uint16_t) + 3 * sizeof(float)));
+
+	// Every value is within half a step of its range
+	const auto& arrays = quantized.getArrays();
+	for (std::size_t i = 0; i < cloud.size(); ++i) {
+		for (int d = 0; d < 2; ++d) {
+			float position = ez::intern::dequantize(arrays.position[d][i], arrays.positionRange[d]);
+			float domain = ez::intern::dequantize(arrays.domain[d][i], arrays.domainRange[d]);
+			REQUIRE(position == Approx(cloud[i].position[d]).margin(arrays.positionRange[d].scale * 0.5f + 1e-6f));
+			REQUIRE(domain == Approx(cloud[i].domain[d]).margin(arrays.domainRange[d].scale * 0.5f + 1e-6f));
+		}
+	}
+
+	std::mt19937 gen{ 7 };
+	std::uniform_real_distribution<float> dist{ -12.f, 12.f };
+	std::vector<glm::vec2> inputs(100);
+	for (glm::vec2& input : inputs) {
+		input = glm::vec2{ dist(gen), dist(gen) };
+	}
+
+	std::vector<glm::vec3> results(inputs.size());
+	quantized.evalBatch(inputs.data(), inputs.size(), results.data());
+	for (std::size_t i = 0; i < inputs.size(); ++i) {
+		glm::vec3 expected = cloud.eval(inputs[i]);
+		REQUIRE(results[i].x == Approx(expected.x).margin(1e-2));
+		REQUIRE(results[i].y == Approx(expected.y).margin(1e-2));
+		REQUIRE(results[i].z == Approx(expected.z).margin(1e-2));
+	}
+
+	// Copies rebind the arrays to their own storage
+	ez::QuantizedPointCloud<float, 2, 3> copy = quantized;
+	REQUIRE(copy.getArrays().position[0] != arrays.position[0]);
+	requireEqual(copy.eval(inputs[0]), quantized.eval(inputs[0]));
+}
+
+TEST_CASE("BakedCloud matches PointCloud at the samples") {
+	const Cloud cloud = makeCloud(30);
+
+	ez::execution::parallel_policy policy;
+	policy.threads = 3;
+	policy.grain = 8;
+	const auto baked = cloud.bake(glm::vec2{ -10.f }, glm::vec2{ 10.f }, { 33, 17 }, policy);
+	REQUIRE(baked.size() == 33 * 17);
+
+	for (std::size_t i = 0; i < baked.size(); i += 7) {
+		glm::vec2 position = baked.samplePosition(i);
+		requireEqual(baked.eval(position), cloud.eval(position));
+		requireEqual(baked.evalCubic(position), cloud.eval(position));
+	}
+
+	// Inputs outside of the bounds are clamped
+	requireEqual(baked.eval(glm::vec2{ 50.f, -50.f }), cloud.eval(glm::vec2{ 10.f, -10.f }));
+
+	// A linear function is reproduced exactly between the samples
+	ez::PointCloud<double, 1, 1> line;
+	line.push_back(0.0, 0.0);
+	line[0].tangent[0] = 2.0;
+	const auto bakedLine = line.bake(-1.0, 1.0, { 5 });
+	REQUIRE(bakedLine.eval(0.3) == Approx(0.6));
+	REQUIRE(bakedLine.evalCubic(-0.55) == Approx(-1.1));
+	REQUIRE(bakedLine.measureError(line, ez::execution::seq) == Approx(0.0).margin(1e-9));
+}
+
+TEST_CASE("PointCloud evalWithGradient") {
+	Cloud cloud = makeCloud(25);
+
+	std::mt19937 gen{ 99 };
+	std::uniform_real_distribution<double> dist{ -8.0, 8.0 };
+
+	// Double precision, so central differences are accurate enough to compare against.
+	ez::PointCloud<double, 2, 3> precise;
+	for (const auto& point : cloud) {
+		precise.push_back(glm::dvec2{ point.position }, glm::dvec3{ point.output });
+		auto& added = precise[precise.size() - 1];
+		added.domain = glm::dvec2{ point.domain };
+		added.tangent[0] = glm::dvec3{ point.tangent[0] };
+		added.tangent[1] = glm::dvec3{ 0.0, 0.05, 0.0 };
+	}
+
+	const double h = 1e-6;
+	for (int i = 0; i < 20; ++i) {
+		glm::dvec2 input{ dist(gen), dist(gen) };
+		auto result = precise.evalWithGradient(input);
+
+		glm::dvec3 expected = precise.eval(input);
+		REQUIRE(result.value.x == Approx(expected.x));
+		REQUIRE(result.value.y == Approx(expected.y));
+		REQUIRE(result.value.z == Approx(expected.z));
+
+		for (int d = 0; d < 2; ++d) {
+			glm::dvec2 step{ 0.0 };
+			step[d] = h;
+			glm::dvec3 fd = (precise.eval(input + step) - precise.eval(input - step)) / (2.0 * h);
+			for (int o = 0; o < 3; ++o) {
+				REQUIRE(result.jacobian[d][o] == Approx(fd[o]).epsilon(1e-4).margin(1e-6));
+			}
+		}
+	}
+
+	// Scalar input and output
+	ez::PointCloud<double, 1, 1> line;
+	line.push_back(0.0, 1.0);
+	line.push_back(1.0, 3.0);
+	auto scalar = line.evalWithGradient(0.25);
+	double fd = (line.eval(0.25 + h) - line.eval(0.25 - h)) / (2.0 * h);
+	REQUIRE(scalar.value == Approx(line.eval(0.25)));
+	REQUIRE(scalar.jacobian[0] == Approx(fd).epsilon(1e-4));
+}
+
+namespace {
+	// Check evalAdjoint against central differences of the loss sum(upstream[s] . eval(inputs[s]))
+	template<typename Kernel>
+	void checkAdjoint() {
+		using Precise = ez::PointCloud<double, 2, 3, Kernel>;
+
+		std::mt19937 gen{ 17 };
+		std::uniform_real_distribution<double> dist{ -3.0, 3.0 };
+
+		Precise cloud;
+		for (int i = 0; i < 12; ++i) {
+			cloud.push_back(glm::dvec2{ dist(gen), dist(gen) }, glm::dvec3{ dist(gen), dist(gen), dist(gen) });
+			cloud[i].domain = glm::dvec2{ 0.3 + 0.05 * i, 0.4 };
+			cloud[i].tangent[0] = glm::dvec3{ 0.1 * dist(gen), 0.0, 0.2 };
+			cloud[i].tangent[1] = glm::dvec3{ 0.0, 0.1 * dist(gen), -0.1 };
+		}
+
+		std::vector<glm::dvec2> inputs(30);
+		std::vector<glm::dvec3> upstream(inputs.size());
+		for (std::size_t s = 0; s < inputs.size(); ++s) {
+			inputs[s] = glm::dvec2{ dist(gen), dist(gen) };
+			upstream[s] = glm::dvec3{ dist(gen), dist(gen), dist(gen) };
+		}
+
+		auto loss = [&](const Precise& c) {
+			double total = 0.0;
+			for (std::size_t s = 0; s < inputs.size(); ++s) {
+				total += glm::dot(upstream[s], c.eval(inputs[s]));
+			}
+			return total;
+		};
+
+		std::vector<typename Precise::Point> gradients(cloud.size()), parallel(cloud.size());
+		cloud.evalAdjoint(inputs.data(), upstream.data(), inputs.size(), gradients.data());
+
+		ez::execution::parallel_policy policy;
+		policy.threads = 3;
+		policy.grain = 2;
+		cloud.evalAdjoint(inputs.data(), upstream.data(), inputs.size(), parallel.data(), policy);
+
+		const double h = 1e-6;
+		for (std::size_t j = 0; j < cloud.size(); ++j) {
+			REQUIRE(gradients[j].output == parallel[j].output);
+			REQUIRE(gradients[j].position == parallel[j].position);
+
+			auto central = [&](auto field) {
+				Precise plus = cloud, minus = cloud;
+				field(plus[j]) += h;
+				field(minus[j]) -= h;
+				return (loss(plus) - loss(minus)) / (2.0 * h);
+			};
+
+			for (int d = 0; d < 2; ++d) {
+				double position = central([d](auto& point) -> double& { return point.position[d]; });
+				double domain = central([d](auto& point) -> double& { return point.domain[d]; });
+				REQUIRE(gradients[j].position[d] == Approx(position).epsilon(1e-4).margin(1e-6));
+				REQUIRE(gradients[j].domain[d] == Approx(domain).epsilon(1e-4).margin(1e-6));
+				for (int o = 0; o < 3; ++o) {
+					double tangent = central([d, o](auto& point) -> double& { return point.tangent[d][o]; });
+					REQUIRE(gradients[j].tangent[d][o] == Approx(tangent).epsilon(1e-4).margin(1e-6));
+				}
+			}
+			for (int o = 0; o < 3; ++o) {
+				double output = central([o](auto& point) -> double& { return point.output[o]; });
+				REQUIRE(gradients[j].output[o] == Approx(output).epsilon(1e-4).margin(1e-6));
+			}
+		}
+	}
+}
+
+TEST_CASE("PointCloud evalAdjoint") {
+	checkAdjoint<ez::weighting::InversePower<2>>();
+	checkAdjoint<ez::weighting::Gaussian>();
+	checkAdjoint<ez::weighting::Wendland>();
+}
+
+TEST_CASE("RBFCloud interpolates the points") {
+	// Jittered grid, so every point has neighbours within the support
+	std::mt19937 gen{ 5 };
+	std::uniform_real_distribution<float> jitter{ -0.2f, 0.2f };
+
+	Cloud cloud;
+	for (int y = 0; y < 12; ++y) {
+		for (int x = 0; x < 12; ++x) {
+			glm::vec2 position{ float(x) + jitter(gen), float(y) + jitter(gen) };
+			cloud.push_back(position, glm::vec3{ std::sin(position.x), std::cos(position.y), position.x * 0.1f });
+		}
+	}
+
+	ez::RBFCloud<float, 2, 3> rbf{ cloud, 2.5f };
+	REQUIRE(rbf.isConverged());
+	REQUIRE(rbf.size() == cloud.size());
+
+	for (std::size_t i = 0; i < cloud.size(); ++i) {
+		requireEqual(rbf.eval(cloud[i].position), cloud[i].output);
+	}
+
+	// Nothing within the support
+	requireEqual(rbf.eval(glm::vec2{ 50.f, 50.f }), glm::vec3{ 0.f });
+
+	std::vector<glm::vec2> inputs{ { 3.3f, 4.1f }, { 0.5f, 10.2f }, { 7.f, 7.f } };
+	std::vector<glm::vec3> outputs(inputs.size());
+	rbf.evalBatch(inputs.data(), inputs.size(), outputs.data(), ez::execution::par);
+	for (std::size_t i = 0; i < inputs.size(); ++i) {
+		requireEqual(outputs[i], rbf.eval(inputs[i]));
+	}
+}
+
+TEST_CASE("PointCloud evalApprox") {
+	Cloud cloud = makeCloud(2000);
+	for (std::size_t i = 0; i < cloud.size(); i += 5) {
+		cloud[i].tangent[1] = glm::vec3{ 0.f, -0.2f, 0.1f };
+	}
+
+	std::mt19937 gen{ 17 };
+	std::uniform_real_distribution<float> dist{ -12.f, 12.f };
+	std::vector<glm::vec2> inputs(50);
+	for (glm::vec2& input : inputs) {
+		input = glm::vec2{ dist(gen), dist(gen) };
+	}
+
+	// No index, same as eval
+	requireEqual(cloud.evalApprox(inputs[0], 0.5f), cloud.eval(inputs[0]));
+
+	cloud.buildIndex();
+	for (const glm::vec2& input : inputs) {
+		// Nodes are never approximated with a zero angle
+		requireEqual(cloud.evalApprox(input, 0.f), cloud.eval(input));
+
+		// With outputs in [-10, 10] a theta of 0.5 stays within about 0.05, see tests/bench/approx.cpp
+		glm::vec3 exact = cloud.eval(input);
+		glm::vec3 approx = cloud.evalApprox(input, 0.5f);
+		for (int o = 0; o < 3; ++o) {
+			REQUIRE(approx[o] == Approx(exact[o]).margin(0.05));
+		}
+	}
+
+	// Still interpolates the points, the nearest node is always opened.
+	const Cloud& indexed = cloud;
+	for (std::size_t i = 0; i < indexed.size(); i += 97) {
+		requireEqual(indexed.evalApprox(indexed[i].position, 0.5f), indexed[i].output);
+	}
+	REQUIRE(indexed.hasIndex());
+}
+
+namespace {
+	// User defined kernel, inverse distance to the fourth with no epsilon offset.
+	struct InverseFourth {
+		template<typename T>
+		static T weight(T dist2) {
+			return T(1) / (T(1e-12) + dist2 * dist2);
+		}
+		template<typename T>
+		static T derivative(T dist2) {
+			T w = weight(dist2);
+			return T(-2) * w * w * dist2;
+		}
+		template<typename T>
+		static constexpr T cutoff() {
+			return std::numeric_limits<T>::infinity();
+		}
+	};
+
+	// Same as InverseFourth, but the cutoff is not constexpr so it can not be used by PointCloud.
+	struct RuntimeCutoff : InverseFourth {
+		template<typename T>
+		static T cutoff() {
+			return std::numeric_limits<T>::infinity();
+		}
+	};
+
+	template<typename Kernel>
+	ez::PointCloud<double, 2, 1, Kernel> makeKernelCloud() {
+		std::mt19937 gen{ 31 };
+		std::uniform_real_distribution<double> dist{ -5.0, 5.0 };
+
+		ez::PointCloud<double, 2, 1, Kernel> cloud;
+		for (int i = 0; i < 300; ++i) {
+			cloud.push_back(glm::dvec2{ dist(gen), dist(gen) }, dist(gen));
+			cloud[i].domain = glm::dvec2{ 0.5 };
+			cloud[i].tangent[1] = 0.1;
+		}
+		return cloud;
+	}
+
+	template<typename Kernel>
+	void checkKernel() {
+		auto cloud = makeKernelCloud<Kernel>();
+		ez::PackedPointCloud<double, 2, 1, Kernel> packed{ cloud };
+
+		std::mt19937 gen{ 8 };
+		std::uniform_real_distribution<double> dist{ -5.0, 5.0 };
+		std::vector<glm::dvec2> inputs(30);
+		std::vector<double> expected(inputs.size());
+		for (std::size_t i = 0; i < inputs.size(); ++i) {
+			inputs[i] = glm::dvec2{ dist(gen), dist(gen) };
+			expected[i] = cloud.eval(inputs[i]);
+			REQUIRE(packed.eval(inputs[i]) == Approx(expected[i]));
+		}
+
+		// The cutoff early out through the index gives the same results
+		cloud.buildIndex();
+		const auto& indexed = cloud;
+		const double h = 1e-6;
+		for (std::size_t i = 0; i < inputs.size(); ++i) {
+			REQUIRE(indexed.eval(inputs[i]) == Approx(expected[i]));
+
+			auto result = indexed.evalWithGradient(inputs[i]);
+			REQUIRE(result.value == Approx(expected[i]));
+			for (int d = 0; d < 2; ++d) {
+				glm::dvec2 step{ 0.0 };
+				step[d] = h;
+				double fd = (indexed.eval(inputs[i] + step) - indexed.eval(inputs[i] - step)) / (2.0 * h);
+				REQUIRE(result.jacobian[d] == Approx(fd).epsilon(1e-4).margin(1e-6));
+			}
+		}
+	}
+}
+
+TEST_CASE("PointCloud weighting kernels") {
+	checkKernel<ez::weighting::InversePower<2>>();
+	checkKernel<ez::weighting::InversePower<3>>();
+	checkKernel<ez::weighting::Gaussian>();
+	checkKernel<ez::weighting::Wendland>();
+	checkKernel<InverseFourth>();
+
+	// The default kernel
+	static_assert(std::is_same_v<Cloud::kernel_t, ez::weighting::InversePower<2>>);
+
+	// The cutoff of a kernel has to be usable in constant expressions
+	static_assert(ez::weighting::has_constexpr_cutoff_v<ez::weighting::Wendland, float>);
+	static_assert(ez::weighting::has_constexpr_cutoff_v<InverseFourth, double>);
+	static_assert(!ez::weighting::has_constexpr_cutoff_v<RuntimeCutoff, float>);
+
+	// Wendland is zero outside of the domain scaled radius
+	ez::PointCloud<float, 1, 1, ez::weighting::Wendland> line;
+	line.push_back(0.f, 1.f);
+	line[0].domain = 4.f;
+	REQUIRE(line.eval(0.49f) == Approx(1.f));
+	REQUIRE(line.eval(0.51f) == 0.f);
+}
+
+TEST_CASE("PointCloud evalWeights") {
+	Cloud cloud = makeCloud(200);
+	for (Cloud::Point& point : cloud) {
+		point.tangent[0] = glm::vec3{ 0.f };
+	}
+	cloud.buildIndex();
+	const Cloud& indexed = cloud;
+
+	std::mt19937 gen{ 3 };
+	std::uniform_real_distribution<float> dist{ -10.f, 10.f };
+	for (int i = 0; i < 30; ++i) {
+		glm::vec2 input{ dist(gen), dist(gen) };
+
+		std::array<std::size_t, 6> indices;
+		std::array<float, 6> weights;
+		std::size_t count = indexed.evalWeights(input, 6, indices.data(), weights.data());
+		REQUIRE(count == 6);
+
+		// Without tangents blending the outputs is the same as evalNearest
+		float sum = 0.f;
+		glm::vec3 blended{ 0.f };
+		for (std::size_t j = 0; j < count; ++j) {
+			REQUIRE(weights[j] >= 0.f);
+			if (j != 0) {
+				REQUIRE(weights[j] <= weights[j - 1]);
+			}
+			sum += weights[j];
+			blended += indexed[indices[j]].output * weights[j];
+		}
+		REQUIRE(sum == Approx(1.f));
+		requireEqual(blended, indexed.evalNearest(input, 6));
+	}
+
+	// Fewer points than requested
+	Cloud small = makeCloud(3);
+	std::array<std::size_t, 8> indices;
+	std::array<float, 8> weights;
+	REQUIRE(small.evalWeights(glm::vec2{ 0.f }, 8, indices.data(), weights.data()) == 3);
+	REQUIRE(weights[0] + weights[1] + weights[2] == Approx(1.f));
+
+	// Outside the support of a compact kernel nothing is blended, the same as eval
+	ez::PointCloud<float, 1, 1, ez::weighting::Wendland> line;
+	for (int i = 0; i < 4; ++i) {
+		line.push_back(float(i), float(i + 1));
+		line[i].domain = 4.f;
+	}
+	REQUIRE(line.evalWeights(100.f, 2, indices.data(), weights.data()) == 0);
+	REQUIRE(line.evalNearest(100.f, 2) == 0.f);
+	REQUIRE(line.eval(100.f) == 0.f);
+	REQUIRE(line.evalWeights(1.1f, 2, indices.data(), weights.data()) == 2);
+	REQUIRE(weights[0] == Approx(1.f));
+	REQUIRE(line.evalNearest(1.1f, 2) == Approx(line.eval(1.1f)));
+}
+
+namespace {
+	using Sorted = ez::SortedPointCloud<glm::vec3>;
+
+	Sorted makeSorted(Sorted::index_t points, Sorted::index_t inputs) {
+		std::mt19937 gen{ 77 };
+		std::uniform_real_distribution<float> dist{ -1.f, 1.f };
+
+		Sorted cloud{ points, inputs };
+		for (Sorted::Point point : cloud) {
+			point.value() = glm::vec3{ dist(gen), dist(gen), dist(gen) };
+			for (Sorted::KnotRef knot : point) {
+				knot.position = dist(gen);
+				knot.domain = 1.f + 0.5f * dist(gen);
+				knot.tangent = glm::vec3{ dist(gen), 0.f, 0.1f };
+			}
+		}
+		return cloud;
+	}
+
+	// Straightforward evaluation through the knot accessors
+	glm::vec3 sortedReference(const Sorted& cloud, const std::vector<float>& input) {
+		glm::vec3 result{ 0.f };
+		float sum = 0.f;
+		for (Sorted::index_t p = 0; p < cloud.numPoints(); ++p) {
+			glm::vec3 position = cloud.getPoint(p);
+			float value = 0.f;
+			for (Sorted::index_t k = 0; k < cloud.numInputs(); ++k) {
+				Sorted::Knot knot = cloud.getKnot(p, k);
+				float tmp = knot.position - input[k];
+				tmp = tmp * tmp;
+				value += knot.domain * tmp;
+				position += knot.tangent * (1.f - 1.f / (tmp * tmp + 1.f));
+			}
+			value = 1.f / (0.00001f + value);
+			result += position * value;
+			sum += value;
+		}
+		return sum >= 1e-5f ? result / sum : result;
+	}
+}
+
+TEST_CASE("SortedPointCloud flat storage") {
+	std::mt19937 gen{ 2 };
+	std::uniform_real_distribution<float> dist{ -1.f, 1.f };
+
+	// Both below and above the kernel block size
+	for (Sorted::index_t inputs : { 3, 40, 70 }) {
+		const Sorted cloud = makeSorted(50, inputs);
+
+		std::vector<float> input(inputs);
+		for (float& value : input) {
+			value = dist(gen);
+		}
+		requireEqual(cloud.eval(input.data(), input.data() + inputs), sortedReference(cloud, input));
+		requireEqual(cloud.eval(input.begin(), input.end()), sortedReference(cloud, input));
+	}
+
+	Sorted cloud = makeSorted(4, 3);
+	Sorted::Knot knot = cloud.getKnot(2, 1);
+
+	// Growing the inputs keeps the existing knots, and the new ones are the default
+	cloud.resizeInputs(5);
+	REQUIRE(cloud.getKnot(2, 1).position == knot.position);
+	REQUIRE(cloud.getKnot(2, 4).domain == 1.f);
+
+	cloud.insert(cloud.begin() + 1, glm::vec3{ 9.f });
+	REQUIRE(cloud.numPoints() == 5);
+	REQUIRE(cloud[1].value() == glm::vec3{ 9.f });
+	REQUIRE(cloud.getKnot(3, 1).tangent == knot.tangent);
+
+	cloud.erase(cloud.begin() + 1);
+	REQUIRE(cloud.getKnot(2, 1).position == knot.position);
+
+	cloud.setKnot(0, 0, knot);
+	REQUIRE(cloud[0][0].domain == knot.domain);
+}
+
+TEST_CASE("SortedPointCloud evalCutoff") {
+	Sorted cloud = makeSorted(400, 6);
+	const Sorted& indexed = cloud;
+
+	std::mt19937 gen{ 12 };
+	std::uniform_real_distribution<float> dist{ -1.f, 1.f };
+	std::vector<std::vector<float>> inputs(20, std::vector<float>(6));
+	for (auto& input : inputs) {
+		for (float& value : input) {
+			value = dist(gen);
+		}
+	}
+
+	// Without an index every point is checked
+	std::vector<glm::vec3> scanned;
+	std::vector<Sorted::CutoffStats> scans;
+	for (const auto& input : inputs) {
+		Sorted::CutoffStats stats;
+		scanned.push_back(indexed.evalCutoff(input.data(), 0.5f, &stats));
+		scans.push_back(stats);
+		REQUIRE(stats.visited == 400);
+
+		// Nothing is dropped with an infinite cutoff
+		requireEqual(indexed.evalCutoff(input.data(), std::numeric_limits<float>::infinity()), indexed.eval(input.data(), input.data() + input.size()));
+	}
+
+	cloud.buildIndex();
+	REQUIRE(indexed.hasIndex());
+
+	for (std::size_t i = 0; i < inputs.size(); ++i) {
+		const auto& input = inputs[i];
+
+		Sorted::CutoffStats stats;
+		glm::vec3 pruned = indexed.evalCutoff(input.data(), 0.5f, &stats);
+		REQUIRE(stats.included == scans[i].included);
+		REQUIRE(stats.visited < 400);
+		requireEqual(pruned, scanned[i]);
+
+		// The point values with their tangents stay within a few units of the origin, so the spread is well under 10.
+		if (stats.included != 0) {
+			glm::vec3 expected = indexed.eval(input.data(), input.data() + input.size());
+			float error = glm::length(pruned - expected);
+			REQUIRE(error <= stats.errorBound() * 10.f + 1e-4f);
+		}
+	}
+
+	// Editing the knots invalidates the index
+	cloud.getKnot(0, 0).position = 0.f;
+	REQUIRE(!indexed.hasIndex());
+}
+
+TEST_CASE("SortedPointCloud incremental evaluator") {
+	const Sorted cloud = makeSorted(100, 8);
+
+	std::mt19937 gen{ 4 };
+	std::uniform_real_distribution<float> dist{ -1.f, 1.f };
+	std::uniform_int_distribution<int> pick{ 0, 7 };
+
+	std::vector<float> input(8);
+	for (float& value : input) {
+		value = dist(gen);
+	}
+
+	// Short interval, so the periodic recompute is exercised too
+	Sorted::Evaluator evaluator{ cloud, 16 };
+	requireEqual(evaluator.reset(input.data()), cloud.eval(input.data(), input.data() + 8));
+
+	for (int i = 0; i < 100; ++i) {
+		int k = pick(gen);
+		input[k] = dist(gen);
+
+		glm::vec3 result = evaluator.setInput(k, input[k]);
+		REQUIRE(result == evaluator.value());
+		requireEqual(result, cloud.eval(input.data(), input.data() + 8));
+	}
+	REQUIRE(evaluator.getInputs() == input);
+}
+
+TEST_CASE("SortedPointCloud evalBatch") {
+	// Enough points for several point blocks
+	const Sorted cloud = makeSorted(3000, 5);
+
+	std::mt19937 gen{ 21 };
+	std::uniform_real_distribution<float> dist{ -1.f, 1.f };
+
+	// Padded rows, to check the stride
+	const std::size_t count = 70, stride = 7;
+	std::vector<float> inputs(count * stride);
+	for (float& value : inputs) {
+		value = dist(gen);
+	}
+
+	std::vector<glm::vec3> serial(count), parallel(count);
+	cloud.evalBatch(inputs.data(), count, stride, serial.data());
+
+	ez::execution::parallel_policy policy;
+	policy.threads = 3;
+	policy.grain = 8;
+	cloud.evalBatch(inputs.data(), count, stride, parallel.data(), policy);
+
+	for (std::size_t i = 0; i < count; ++i) {
+		const float* input = inputs.data() + i * stride;
+		requireEqual(serial[i], cloud.eval(input, input + 5));
+		REQUIRE(serial[i] == parallel[i]);
+	}
+}
+
+TEST_CASE("Cloud store round trip") {
+	const Cloud cloud = makeCloud(37);
+
+	// 8 byte aligned buffer, like a memory mapped file
+	std::vector<std::uint64_t> storage(ez::cloudStoreSize(cloud) / 8 + 1);
+	char* bytes = reinterpret_cast<char*>(storage.data());
+	REQUIRE(ez::writeCloudStore(cloud, bytes) == ez::cloudStoreSize(cloud));
+
+	ez::PointCloudView<float, 2, 3> view;
+	REQUIRE(view.assign(bytes, ez::cloudStoreSize(cloud)));
+	REQUIRE(view.size() == cloud.size());
+
+	std::mt19937 gen{ 40 };
+	std::uniform_real_distribution<float> dist{ -10.f, 10.f };
+	for (int i = 0; i < 20; ++i) {
+		glm::vec2 input{ dist(gen), dist(gen) };
+		requireEqual(view.eval(input), cloud.eval(input));
+	}
+
+	// Mismatched types and truncated buffers are rejected
+	ez::PointCloudView<float, 3, 3> wrongInputs;
+	ez::PointCloudView<double, 2, 3> wrongScalar;
+	REQUIRE(!wrongInputs.assign(bytes, ez::cloudStoreSize(cloud)));
+	REQUIRE(!wrongScalar.assign(bytes, ez::cloudStoreSize(cloud)));
+	REQUIRE(!view.assign(bytes, ez::cloudStoreSize(cloud) - 1));
+	REQUIRE(view.empty());
+
+	// So are stores written with a different kernel, including user kernels without an id
+	ez::PointCloudView<float, 2, 3, ez::weighting::Wendland> wrongKernel;
+	ez::PointCloudView<float, 2, 3, InverseFourth> userKernel;
+	REQUIRE(!wrongKernel.assign(bytes, ez::cloudStoreSize(cloud)));
+	REQUIRE(!userKernel.assign(bytes, ez::cloudStoreSize(cloud)));
+
+	ez::PointCloud<float, 2, 3, ez::weighting::Wendland> compact;
+	for (const Cloud::Point& point : cloud) {
+		compact.push_back(point.position, point.output);
+	}
+	std::vector<std::uint64_t> compactStorage(ez::cloudStoreSize(compact) / 8 + 1);
+	char* compactBytes = reinterpret_cast<char*>(compactStorage.data());
+	ez::writeCloudStore(compact, compactBytes);
+	REQUIRE(wrongKernel.assign(compactBytes, ez::cloudStoreSize(compact)));
+	REQUIRE(!view.assign(compactBytes, ez::cloudStoreSize(compact)));
+
+	const Sorted sorted = makeSorted(25, 9);
+	const std::size_t sortedSize = ez::cloudStoreSize(sorted);
+	std::vector<std::uint64_t> sortedStorage(sortedSize / 8 + 1);
+	char* sortedBytes = reinterpret_cast<char*>(sortedStorage.data());
+	REQUIRE(ez::writeCloudStore(sorted, sortedBytes) == sortedSize);
+
+	ez::SortedPointCloudView<glm::vec3> sortedView{ sortedBytes, sortedSize };
+	REQUIRE(sortedView.numPoints() == 25);
+	REQUIRE(sortedView.numInputs() == 9);
+
+	std::vector<float> input(9);
+	for (float& value : input) {
+		value = dist(gen) * 0.1f;
+	}
+	REQUIRE(sortedView.eval(input.data()) == sorted.eval(input.data(), input.data() + 9));
+
+	// The magic differs between the cloud types
+	REQUIRE(!ez::SortedPointCloudView<glm::vec3>{}.assign(bytes, ez::cloudStoreSize(cloud)));
+}
@@ -0,0 +1,82 @@
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <random>
+
+#include <ez/interpolate/PointCloud.hpp>
+
+/*
+Compares PointCloud::evalApprox against eval for a few values of theta.
+Reports the time per query, the speedup over eval, and the max and mean absolute error of the outputs.
+The output values are uniform in [-10, 10], the same as the cloud in the basic tests.
+*/
+
+namespace {
+	using Cloud = ez::PointCloud<float, 2, 3>;
+
+	Cloud makeCloud(std::size_t count) {
+		std::mt19937 gen{ 1234 };
+		std::uniform_real_distribution<float> dist{ -10.f, 10.f };
+
+		Cloud cloud;
+		for (std::size_t i = 0; i < count; ++i) {
+			cloud.push_back(glm::vec2{ dist(gen), dist(gen) }, glm::vec3{ dist(gen), dist(gen), dist(gen) });
+			cloud[i].domain = glm::vec2{ 1.f + 0.1f * float(i % 3), 1.f };
+			cloud[i].tangent[0] = glm::vec3{ 0.1f, 0.f, 0.f };
+		}
+		return cloud;
+	}
+
+	template<typename F>
+	double timeQueries(const std::vector<glm::vec2>& inputs, std::vector<glm::vec3>& out, F&& eval) {
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < inputs.size(); ++i) {
+			out[i] = eval(inputs[i]);
+		}
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / double(inputs.size());
+	}
+
+	void run(std::size_t points, std::size_t queries) {
+		Cloud cloud = makeCloud(points);
+		cloud.buildIndex();
+		const Cloud& indexed = cloud;
+
+		std::mt19937 gen{ 17 };
+		std::uniform_real_distribution<float> dist{ -12.f, 12.f };
+		std::vector<glm::vec2> inputs(queries);
+		for (glm::vec2& input : inputs) {
+			input = glm::vec2{ dist(gen), dist(gen) };
+		}
+
+		std::vector<glm::vec3> exact(queries), approx(queries);
+		double exactTime = timeQueries(inputs, exact, [&](const glm::vec2& input) { return indexed.eval(input); });
+		std::printf("%zu points, eval %10.2f us\n", points, exactTime * 1e6);
+
+		for (float theta : { 0.25f, 0.5f, 1.f }) {
+			double time = timeQueries(inputs, approx, [&](const glm::vec2& input) { return indexed.evalApprox(input, theta); });
+
+			float maxError = 0.f;
+			double meanError = 0.0;
+			for (std::size_t i = 0; i < queries; ++i) {
+				for (int o = 0; o < 3; ++o) {
+					float error = std::abs(approx[i][o] - exact[i][o]);
+					maxError = std::max(maxError, error);
+					meanError += error;
+				}
+			}
+			meanError /= double(queries * 3);
+
+			std::printf("  theta %4.2f %10.2f us   %6.1fx   max error %.4f   mean error %.5f\n",
+				theta, time * 1e6, exactTime / time, maxError, meanError);
+		}
+	}
+}
+
+int main() {
+	run(2000, 2000);
+	run(200000, 200);
+	return 0;
+}
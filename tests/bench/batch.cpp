@@ -0,0 +1,78 @@
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <iterator>
+#include <algorithm>
+#include <thread>
+
+#include <ez/bezier/OffsetBatch.hpp>
+
+/*
+Compares bezier::pixelOffsetBatch against a loop of pixelOffset calls writing through a back_inserter.
+Reports the time for the whole batch, sequenced and with each thread count up to the hardware concurrency.
+*/
+
+namespace {
+	using vec_t = glm::vec2;
+	using Curve = std::array<vec_t, 4>;
+
+	// Gentle curves like the basic tests, so none of them have cusps
+	std::vector<Curve> makeCurves(std::size_t count) {
+		std::mt19937 gen{ 11 };
+		std::uniform_real_distribution<float> dist{ 0.f, 800.f };
+
+		std::vector<Curve> curves(count);
+		for (Curve& curve : curves) {
+			vec_t start{ dist(gen), dist(gen) };
+			vec_t end = start + vec_t{ 300.f, 0.f };
+			curve = { { start, start + vec_t{ 100.f, dist(gen) * 0.2f }, end - vec_t{ 100.f, dist(gen) * 0.2f }, end } };
+		}
+		return curves;
+	}
+
+	template<typename F>
+	double seconds(F&& func) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main() {
+	constexpr std::size_t count = 1000000;
+	constexpr float delta = 12.f;
+	const std::vector<Curve> curves = makeCurves(count);
+
+	std::vector<vec_t> out;
+	std::vector<std::size_t> offsets;
+
+	double loop = seconds([&]() {
+		out.clear();
+		offsets.assign(1, 0);
+		for (const Curve& curve : curves) {
+			ez::bezier::pixelOffset(curve[0], curve[1], curve[2], curve[3], delta, std::back_inserter(out));
+			offsets.push_back(out.size());
+		}
+	});
+	std::printf("%zu curves, %zu points\n", count, out.size());
+	std::printf("pixelOffset loop  %8.3f s\n", loop);
+
+	double seq = seconds([&]() {
+		ez::bezier::pixelOffsetBatch(curves.data(), curves.size(), delta, out, offsets);
+	});
+	std::printf("batch seq         %8.3f s   %5.2fx\n", seq, loop / seq);
+
+	unsigned hardware = std::max(std::thread::hardware_concurrency(), 1u);
+	for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+		ez::execution::parallel_policy policy;
+		policy.threads = threads;
+
+		double par = seconds([&]() {
+			ez::bezier::pixelOffsetBatch(curves.data(), curves.size(), delta, out, offsets, policy);
+		});
+		std::printf("batch %2u threads  %8.3f s   %5.2fx\n", threads, par, loop / par);
+	}
+	return 0;
+}
@@ -0,0 +1,135 @@
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include <glm/geometric.hpp>
+#include <ez/bezier/Bezier.hpp>
+
+/*
+Compares the sampled error metric of intern::simplePixelOffset against the previous single midpoint metric.
+Reports the number of output segments, the time per offset, and the real max error measured densely against the base curve.
+*/
+
+namespace {
+	using vec_t = glm::vec2;
+	using Curve = std::array<vec_t, 4>;
+
+	// The previous version of simplePixelOffset, kept here as the baseline.
+	template<std::size_t N, typename T, typename output_iter>
+	std::ptrdiff_t midpointPixelOffset(const std::array<glm::tvec2<T>, N>& points, T delta, T threshold, output_iter output) {
+		std::ptrdiff_t count = 0;
+		T compare = std::abs(delta);
+		std::array<glm::tvec2<T>, N> base = points, n, offset;
+
+		T range = T(1);
+		T start = T(0);
+		while (start < range) {
+			for (int i = 0; i < int(N); ++i) {
+				n[i] = ez::bezier::normalAtStatic<N>(base.begin(), T(i) / T(N - 1));
+				offset[i] = base[i] + n[i] * delta;
+			}
+
+			glm::tvec2<T> bp = ez::bezier::interpolateStatic<N>(base.begin(), T(0.5));
+			glm::tvec2<T> op = ez::bezier::interpolateStatic<N>(offset.begin(), T(0.5));
+
+			if (range - start > T(1) / T(4096) && std::abs(glm::length(op - bp) - compare) > threshold) {
+				range = (start + range) * T(0.5);
+				ez::bezier::leftSplitStatic<N>(base.begin(), T(0.5), base.begin());
+				continue;
+			}
+
+			for (int i = 1; i < int(N); ++i) {
+				*output++ = offset[i];
+			}
+			count += N - 1;
+
+			if (range < T(1)) {
+				start = range;
+				range = T(1);
+				ez::bezier::rightSplitStatic<N>(points.begin(), start, base.begin());
+			}
+			else {
+				break;
+			}
+		}
+		return count;
+	}
+
+	// The curve from the gui offset test, and variations of it. None of them turn tighter than the largest offset, where the offset itself is undefined.
+	std::vector<Curve> testCurves() {
+		return {
+			Curve{ vec_t{ 100, 500 }, vec_t{ 100, 100 }, vec_t{ 700, 100 }, vec_t{ 700, 500 } },
+			Curve{ vec_t{ 100, 300 }, vec_t{ 250, 150 }, vec_t{ 450, 450 }, vec_t{ 700, 300 } },
+			Curve{ vec_t{ 100, 300 }, vec_t{ 300, 0 }, vec_t{ 500, 600 }, vec_t{ 700, 300 } },
+			Curve{ vec_t{ 100, 500 }, vec_t{ 400, 100 }, vec_t{ 410, 100 }, vec_t{ 700, 500 } },
+			Curve{ vec_t{ 100, 100 }, vec_t{ 200, 120 }, vec_t{ 500, 80 }, vec_t{ 700, 100 } }
+		};
+	}
+
+	// Largest difference between the distance to the base curve and the offset, sampled densely along the output.
+	float measureError(const Curve& curve, float delta, const std::vector<vec_t>& out) {
+		constexpr int baseSamples = 2048;
+		std::vector<vec_t> dense(baseSamples + 1);
+		for (int i = 0; i <= baseSamples; ++i) {
+			dense[i] = ez::bezier::interpolate(curve[0], curve[1], curve[2], curve[3], float(i) / float(baseSamples));
+		}
+
+		float error = 0.f;
+		for (std::size_t i = 0; i + 3 < out.size(); i += 3) {
+			for (int k = 1; k < 16; ++k) {
+				vec_t p = ez::bezier::interpolate(out[i], out[i + 1], out[i + 2], out[i + 3], float(k) / 16.f);
+				float best = std::numeric_limits<float>::max();
+				for (const vec_t& d : dense) {
+					best = std::min(best, glm::length(p - d));
+				}
+				error = std::max(error, std::abs(best - std::abs(delta)));
+			}
+		}
+		return error;
+	}
+
+	template<typename F>
+	void run(const char* name, F&& offset) {
+		constexpr int repeats = 2000;
+		const std::array<float, 4> deltas{ { 8.f, -8.f, 32.f, -32.f } };
+
+		std::size_t segments = 0;
+		float maxError = 0.f;
+		double seconds = 0.0;
+		std::vector<vec_t> out;
+
+		for (const Curve& curve : testCurves()) {
+			for (float delta : deltas) {
+				auto start = std::chrono::steady_clock::now();
+				for (int r = 0; r < repeats; ++r) {
+					out.clear();
+					out.push_back(curve[0] + ez::bezier::normalAtStatic<4>(curve.begin(), 0.f) * delta);
+					offset(curve, delta, std::back_inserter(out));
+				}
+				seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				segments += (out.size() - 1) / 3;
+				maxError = std::max(maxError, measureError(curve, delta, out));
+			}
+		}
+
+		const std::size_t calls = testCurves().size() * deltas.size();
+		std::printf("%-10s segments %5zu   time per offset %8.3f us   max error %.3f px\n",
+			name, segments, seconds * 1e6 / double(calls * repeats), maxError);
+	}
+}
+
+int main() {
+	run("midpoint", [](const Curve& curve, float delta, auto output) {
+		midpointPixelOffset(curve, delta, 0.5f, output);
+	});
+	run("sampled", [](const Curve& curve, float delta, auto output) {
+		ez::bezier::intern::simplePixelOffset(curve, delta, 0.5f, output);
+	});
+	return 0;
+}
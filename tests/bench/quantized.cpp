@@ -0,0 +1,89 @@
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <random>
+
+#include <ez/interpolate/PointCloud.hpp>
+#include <ez/interpolate/PackedPointCloud.hpp>
+#include <ez/interpolate/QuantizedPointCloud.hpp>
+
+/*
+Compares QuantizedPointCloud::eval against PackedPointCloud::eval for a 3 to 3 cloud,
+from a size that fits in the cache to one limited by memory bandwidth.
+Reports the time per query of each, and the max absolute difference of the outputs.
+*/
+
+namespace {
+	using Cloud = ez::PointCloud<float, 3, 3>;
+	using Packed = ez::PackedPointCloud<float, 3, 3>;
+	using Quantized = ez::QuantizedPointCloud<float, 3, 3>;
+
+	Cloud makeCloud(std::size_t count) {
+		std::mt19937 gen{ 1234 };
+		std::uniform_real_distribution<float> dist{ -10.f, 10.f };
+
+		Cloud cloud;
+		for (std::size_t i = 0; i < count; ++i) {
+			cloud.push_back(glm::vec3{ dist(gen), dist(gen), dist(gen) }, glm::vec3{ dist(gen), dist(gen), dist(gen) });
+			cloud[i].domain = glm::vec3{ 1.f + 0.1f * float(i % 3), 1.f, 1.f };
+			cloud[i].tangent[0] = glm::vec3{ 0.1f, 0.f, 0.f };
+		}
+		return cloud;
+	}
+
+	// Best of several rounds, each evaluating every query once
+	template<typename F>
+	double timeQueries(const std::vector<glm::vec3>& inputs, std::vector<glm::vec3>& out, int rounds, F&& eval) {
+		double best = 1e30;
+		for (int r = 0; r < rounds; ++r) {
+			auto start = std::chrono::steady_clock::now();
+			for (std::size_t i = 0; i < inputs.size(); ++i) {
+				out[i] = eval(inputs[i]);
+			}
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best / double(inputs.size());
+	}
+
+	void run(std::size_t points, std::size_t queries, int rounds) {
+		Packed packed;
+		Quantized quantized;
+		{
+			const Cloud cloud = makeCloud(points);
+			packed = Packed{ cloud };
+			quantized = Quantized{ cloud };
+		}
+
+		std::mt19937 gen{ 17 };
+		std::uniform_real_distribution<float> dist{ -12.f, 12.f };
+		std::vector<glm::vec3> inputs(queries);
+		for (glm::vec3& input : inputs) {
+			input = glm::vec3{ dist(gen), dist(gen), dist(gen) };
+		}
+
+		std::vector<glm::vec3> exact(queries), approx(queries);
+		double packedTime = timeQueries(inputs, exact, rounds, [&](const glm::vec3& input) { return packed.eval(input); });
+		double quantizedTime = timeQueries(inputs, approx, rounds, [&](const glm::vec3& input) { return quantized.eval(input); });
+
+		float maxError = 0.f;
+		for (std::size_t i = 0; i < queries; ++i) {
+			for (int o = 0; o < 3; ++o) {
+				maxError = std::max(maxError, std::abs(approx[i][o] - exact[i][o]));
+			}
+		}
+
+		std::printf("%8zu points  %7.1f MB -> %7.1f MB   packed %10.1f us   quantized %10.1f us   %5.2fx   max difference %.4f\n",
+			points, double(points * 18 * sizeof(float)) / 1e6, double(quantized.memoryUsage()) / 1e6,
+			packedTime * 1e6, quantizedTime * 1e6, packedTime / quantizedTime, maxError);
+	}
+}
+
+int main() {
+	run(20000, 500, 9);
+	run(200000, 100, 7);
+	run(4000000, 10, 5);
+	return 0;
+}
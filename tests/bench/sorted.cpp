@@ -0,0 +1,138 @@
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <random>
+
+#include <glm/vec3.hpp>
+#include <ez/interpolate/intern/SortedPointCloud.hpp>
+
+/*
+Compares SortedPointCloud::eval on the flat row major knot arrays against the previous layout, a vector of knots per point.
+Both are evaluated on the same data with hot caches, and the time per evaluation is reported for a few cloud shapes.
+*/
+
+namespace {
+	using vec_t = glm::vec3;
+	using real_t = float;
+	using Sorted = ez::SortedPointCloud<vec_t>;
+
+	// The previous layout of SortedPointCloud, kept here as the baseline.
+	struct NestedCloud {
+		struct Knot {
+			real_t position;
+			real_t domain;
+			vec_t tangent;
+		};
+		struct Point {
+			vec_t value;
+			std::vector<Knot> knots;
+		};
+		std::vector<Point> points;
+
+		explicit NestedCloud(const Sorted& cloud) {
+			const std::size_t m = static_cast<std::size_t>(cloud.numInputs());
+			points.resize(static_cast<std::size_t>(cloud.numPoints()));
+			for (std::size_t p = 0; p < points.size(); ++p) {
+				points[p].value = cloud.pointData()[p];
+				for (std::size_t k = 0; k < m; ++k) {
+					std::size_t i = p * m + k;
+					points[p].knots.push_back(Knot{ cloud.knotPositionData()[i], cloud.knotDomainData()[i], cloud.knotTangentData()[i] });
+				}
+			}
+		}
+
+		vec_t eval(const real_t* input) const {
+			vec_t result(0);
+			real_t sum = real_t(0);
+
+			for (const Point& point : points) {
+				real_t value = real_t(0);
+				vec_t position = point.value;
+
+				const real_t* it = input;
+				for (const Knot& knot : point.knots) {
+					real_t tmp = (knot.position - *it);
+					tmp = tmp * tmp;
+					value += knot.domain * tmp;
+
+					tmp = real_t(1) - real_t(1) / (tmp * tmp + real_t(1));
+					position += knot.tangent * tmp;
+					++it;
+				}
+
+				value = real_t(1) / (real_t(0.00001) + value);
+				result += position * value;
+				sum += value;
+			}
+
+			if (sum >= real_t(1E-5)) {
+				result /= sum;
+			}
+			return result;
+		}
+	};
+
+	Sorted makeSorted(Sorted::index_t points, Sorted::index_t inputs) {
+		std::mt19937 gen{ 77 };
+		std::uniform_real_distribution<float> dist{ -1.f, 1.f };
+
+		Sorted cloud{ points, inputs };
+		for (Sorted::Point point : cloud) {
+			point.value() = vec_t{ dist(gen), dist(gen), dist(gen) };
+			for (Sorted::KnotRef knot : point) {
+				knot.position = dist(gen);
+				knot.domain = 1.f + 0.5f * dist(gen);
+				knot.tangent = vec_t{ dist(gen), dist(gen), dist(gen) } * 0.1f;
+			}
+		}
+		return cloud;
+	}
+
+	// Best of several rounds, each evaluating every input once
+	template<typename F>
+	double timeQueries(const std::vector<real_t>& inputs, std::size_t m, vec_t& sink, F&& eval) {
+		const std::size_t queries = inputs.size() / m;
+		double best = 1e30;
+		for (int r = 0; r < 7; ++r) {
+			auto start = std::chrono::steady_clock::now();
+			for (std::size_t q = 0; q < queries; ++q) {
+				sink += eval(inputs.data() + q * m);
+			}
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best / double(queries);
+	}
+
+	void run(Sorted::index_t points, Sorted::index_t inputs, std::size_t queries) {
+		const Sorted cloud = makeSorted(points, inputs);
+		const NestedCloud nested{ cloud };
+		const std::size_t m = static_cast<std::size_t>(inputs);
+
+		std::mt19937 gen{ 5 };
+		std::uniform_real_distribution<float> dist{ -1.f, 1.f };
+		std::vector<real_t> values(queries * m);
+		for (real_t& value : values) {
+			value = dist(gen);
+		}
+
+		vec_t sink(0);
+		double nestedTime = timeQueries(values, m, sink, [&](const real_t* input) { return nested.eval(input); });
+		double flatTime = timeQueries(values, m, sink, [&](const real_t* input) { return cloud.eval(input, input + m); });
+
+		std::printf("%6td points %4td inputs   nested %9.2f us   flat %9.2f us   %5.2fx   (%g)\n",
+			points, inputs, nestedTime * 1e6, flatTime * 1e6, nestedTime / flatTime, double(sink.x));
+	}
+}
+
+int main() {
+	run(2000, 3, 2000);
+	run(2000, 8, 1000);
+	run(2000, 16, 500);
+	run(2000, 32, 300);
+	run(2000, 40, 200);
+	run(200, 40, 2000);
+	run(500, 160, 200);
+	return 0;
+}
@@ -2,8 +2,7 @@
 
 #include <glm/geometric.hpp>
 
-#include "BPath2.hpp"
-#include <ez/bezier/BPath.hpp>
+#include <ez/bezier/CornerPath.hpp>
 
 #include <gl/glew.h>
 #include "nanovg.h"
@@ -11,16 +10,18 @@
 
 class bpath : public Engine {
 public:
-	using Path = ez::ClosedPath;
+	using Path = ez::CornerPath<glm::vec2>;
 
 	bpath()
 		: Engine("BPath test")
 		, index(-1)
 		, closed(true)
 	{
+		path.setClosed(closed);
 		for (float t = 0, end = ez::tau<float>() *(11.0 / 12.0); t <= end; t += ez::tau<float>() / 6.f) {
-			path.append({ -std::cos(-t)*0.4 +0.5, std::sin(-t)*0.4 +0.5 });
+			path.append(glm::vec2(-std::cos(-t)*0.4 +0.5, std::sin(-t)*0.4 +0.5));
 		}
+		path.setCorner(0, true);
 		//path.append({ false, { 0.2, 0.8 } });
 		//path.append({ false, { 0.2, 0.2 }});
 		//path.append({ false, { 0.4, 0.1 }});
@@ -42,7 +43,7 @@ public:
 
 				std::ptrdiff_t count = static_cast<std::ptrdiff_t>(path.size());
 				for (std::ptrdiff_t i = 0; i < count; ++i) {
-					glm::vec2 cpos = path[i];
+					glm::vec2 cpos = path[i].position;
 					float dist1 = glm::length(cpos * frame - mpos);
 					if (dist1 < dist2) {
 						select = i;
@@ -52,6 +53,27 @@ public:
 
 				index = select;
 			}
+			else if (ev.type == ez::InputEventType::MousePress && ev.mouse.buttons == ez::Mouse::Right) {
+				// Toggle the corner flag of the nearest control
+				glm::vec2 mpos = ev.mouse.position;
+				glm::vec2 frame = getFrameSize();
+
+				float dist2 = 8;
+				std::ptrdiff_t select = -1;
+
+				std::ptrdiff_t count = static_cast<std::ptrdiff_t>(path.size());
+				for (std::ptrdiff_t i = 0; i < count; ++i) {
+					float dist1 = glm::length(path[i].position * frame - mpos);
+					if (dist1 < dist2) {
+						select = i;
+						dist2 = dist1;
+					}
+				}
+
+				if (select != -1) {
+					path.setCorner(select, !path[select].corner);
+				}
+			}
 		}
 		else {
 			if (ev.type == ez::InputEventType::MouseRelease && ev.mouse.buttons == ez::Mouse::Left) {
@@ -62,7 +84,7 @@ public:
 				glm::vec2 frame = getFrameSize();
 				mpos /= frame;
 
-				path[index] = mpos;
+				path.setPosition(index, mpos);
 			}
 		}
 	}
@@ -79,11 +101,14 @@ public:
 		strokeWidth(6.f);
 		
 		for (std::ptrdiff_t i = 0; i < path.size(); ++i) {
-			const glm::vec2 & point = path[i];
+			const glm::vec2 & point = path[i].position;
 
 			if (i == index) {
 				fillColor(1, 0, 0);
 			}
+			else if (path[i].corner) {
+				fillColor(0, 0.6, 0.1);
+			}
 			else {
 				fillColor(0, 0, 1);
 			}